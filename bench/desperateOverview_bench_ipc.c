@@ -0,0 +1,257 @@
+#define _GNU_SOURCE
+
+/*
+ * Refresh latency and CPU-per-event benchmark for the core IPC path.
+ * Run it against tools/desperateOverview-fake-ipc-server started with
+ * --wait-start, using the XDG_RUNTIME_DIR/HYPRLAND_INSTANCE_SIGNATURE it
+ * prints:
+ *
+ *   tools/desperateOverview-fake-ipc-server --runtime-dir /tmp/fake \
+ *       --fixtures tools/fixtures/basic --events tools/fixtures/basic/events.txt \
+ *       --rate 0 --loop --wait-start &
+ *   XDG_RUNTIME_DIR=/tmp/fake HYPRLAND_INSTANCE_SIGNATURE=desperateOverview-fake \
+ *       bench/desperateOverview_bench_ipc --events 20000
+ *
+ * --capture-backend wayland captures through the real export protocol
+ * instead; pair it with tools/desperateOverview-fake-export-server and
+ * point WAYLAND_DISPLAY at its socket.
+ *
+ * Every query gives up after the core's 5 s reply timeout, and the event
+ * phase fails (exit 1) when the server stops answering or the events do
+ * not arrive within --timeout-ms, so a stuck server cannot hang the run.
+ */
+
+#include "desperateOverview_capture_backend.h"
+#include "desperateOverview_config.h"
+#include "desperateOverview_core.h"
+#include "desperateOverview_core_ipc.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    int iterations;
+    unsigned long events;
+    int timeout_ms;
+    bool capture;
+    bool wayland_capture;
+    const char *config_path;
+} BenchOptions;
+
+static atomic_ulong g_redraws;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t cpu_ns(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000ull +
+           (uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ull;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const uint64_t *sorted, int n, double p) {
+    if (n <= 0)
+        return 0.0;
+    int idx = (int)(p * (double)(n - 1) + 0.5);
+    return (double)sorted[idx] / 1e6;
+}
+
+static void on_redraw(void *user_data) {
+    (void)user_data;
+    atomic_fetch_add(&g_redraws, 1);
+}
+
+/* Reads one "key value" line from the fake server's fake/stats reply;
+ * false when the server did not answer. */
+static bool fake_stat(const char *key, unsigned long long *out) {
+    char *reply = desperateOverview_core_ipc_request("fake/stats", NULL);
+    if (!reply) {
+        fprintf(stderr, "bench: fake/stats got no reply\n");
+        return false;
+    }
+    unsigned long long value = 0;
+    size_t key_len = strlen(key);
+    for (char *line = reply; line && *line;) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ' ') {
+            value = strtoull(line + key_len + 1, NULL, 10);
+            break;
+        }
+        line = strchr(line, '\n');
+        if (line)
+            line++;
+    }
+    free(reply);
+    *out = value;
+    return true;
+}
+
+static void bench_refresh_latency(int iterations) {
+    uint64_t *samples = calloc((size_t)iterations, sizeof(*samples));
+    if (!samples)
+        return;
+
+    uint64_t cpu_start = cpu_ns();
+    for (int i = 0; i < iterations; ++i) {
+        uint64_t t0 = now_ns();
+        desperateOverview_core_request_full_refresh();
+        samples[i] = now_ns() - t0;
+    }
+    uint64_t cpu_used = cpu_ns() - cpu_start;
+
+    qsort(samples, (size_t)iterations, sizeof(*samples), cmp_u64);
+    printf("refresh.iterations %d\n", iterations);
+    printf("refresh.min_ms %.3f\n", (double)samples[0] / 1e6);
+    printf("refresh.p50_ms %.3f\n", percentile_ms(samples, iterations, 0.50));
+    printf("refresh.p95_ms %.3f\n", percentile_ms(samples, iterations, 0.95));
+    printf("refresh.p99_ms %.3f\n", percentile_ms(samples, iterations, 0.99));
+    printf("refresh.max_ms %.3f\n", (double)samples[iterations - 1] / 1e6);
+    printf("refresh.cpu_ms_per_refresh %.3f\n", (double)cpu_used / 1e6 / iterations);
+    free(samples);
+}
+
+static bool bench_event_stream(unsigned long events, int timeout_ms) {
+    atomic_store(&g_redraws, 0);
+    unsigned long long sent_before = 0;
+    if (!fake_stat("events_sent", &sent_before))
+        return false;
+
+    char *ack = desperateOverview_core_ipc_request("fake/start", NULL);
+    if (!ack) {
+        fprintf(stderr, "bench: fake/start failed, is the fake IPC server running?\n");
+        return false;
+    }
+    free(ack);
+
+    uint64_t wall_start = now_ns();
+    uint64_t cpu_start = cpu_ns();
+    uint64_t deadline = wall_start + (uint64_t)timeout_ms * 1000000ull;
+    unsigned long long sent = 0;
+    bool finished = false;
+
+    /* Stop once the requested number of events went out (or the script
+     * ended) and the listener has drained: no new redraw for 100 ms. */
+    unsigned long last_redraws = 0;
+    uint64_t last_change = wall_start;
+    while (now_ns() < deadline) {
+        usleep(10000);
+        unsigned long long sent_total = 0, script_done = 0;
+        if (!fake_stat("events_sent", &sent_total) || !fake_stat("script_done", &script_done))
+            return false;
+        sent = sent_total - sent_before;
+        unsigned long redraws = atomic_load(&g_redraws);
+        if (redraws != last_redraws) {
+            last_redraws = redraws;
+            last_change = now_ns();
+        }
+        bool enough = sent >= events || script_done;
+        if (enough && now_ns() - last_change > 100000000ull) {
+            finished = true;
+            break;
+        }
+    }
+
+    uint64_t wall_used = now_ns() - wall_start;
+    uint64_t cpu_used = cpu_ns() - cpu_start;
+    unsigned long redraws = atomic_load(&g_redraws);
+
+    printf("events.sent %llu\n", sent);
+    printf("events.refreshes %lu\n", redraws);
+    printf("events.wall_ms %.3f\n", (double)wall_used / 1e6);
+    if (sent > 0)
+        printf("events.cpu_us_per_event %.3f\n", (double)cpu_used / 1e3 / (double)sent);
+    if (redraws > 0)
+        printf("events.cpu_us_per_refresh %.3f\n", (double)cpu_used / 1e3 / (double)redraws);
+    if (!finished)
+        fprintf(stderr, "bench: event phase timed out after %d ms (%llu of %lu events)\n",
+                timeout_ms, sent, events);
+    return finished;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --iterations N   direct full refreshes to time (default 200)\n"
+            "  --events N       events to consume from the fake server (default 10000, 0 = skip)\n"
+            "  --timeout-ms N   upper bound for the event phase (default 30000)\n"
+            "  --no-capture     disable thumbnail capture during refreshes\n"
+            "  --capture-backend synthetic|wayland\n"
+            "                   capture backend (default synthetic; wayland uses WAYLAND_DISPLAY)\n"
+            "  --config PATH    config file (does not select the capture backend)\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opts = {
+        .iterations = 200,
+        .events = 10000,
+        .timeout_ms = 30000,
+        .capture = true,
+        .wayland_capture = false,
+        .config_path = NULL,
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--no-capture") == 0) {
+            opts.capture = false;
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            opts.iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--events") == 0 && i + 1 < argc) {
+            opts.events = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--timeout-ms") == 0 && i + 1 < argc) {
+            opts.timeout_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--capture-backend") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "wayland") == 0) {
+                opts.wayland_capture = true;
+            } else if (strcmp(name, "synthetic") != 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            opts.config_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.iterations <= 0)
+        opts.iterations = 1;
+
+    config_init(opts.config_path);
+    desperateOverview_capture_set_backend(opts.wayland_capture
+                                              ? desperateOverview_capture_backend_wayland()
+                                              : desperateOverview_capture_backend_synthetic());
+
+    if (desperateOverview_core_init(on_redraw, NULL) != 0) {
+        fprintf(stderr, "bench: core init failed (XDG_RUNTIME_DIR / HYPRLAND_INSTANCE_SIGNATURE?)\n");
+        return 1;
+    }
+    desperateOverview_core_set_thumbnail_capture_enabled(opts.capture);
+
+    printf("capture %s\n", !opts.capture ? "off" : opts.wayland_capture ? "wayland" : "synthetic");
+    bench_refresh_latency(opts.iterations);
+    bool ok = true;
+    if (opts.events > 0)
+        ok = bench_event_stream(opts.events, opts.timeout_ms);
+
+    desperateOverview_core_shutdown();
+    config_shutdown();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+#define _GNU_SOURCE
+
+/*
+ * Microbenchmarks for the hot kernels on the refresh and show paths. Results
+ * go to stdout (or --out FILE) as JSON so runs can be compared across
+ * releases; a short human-readable summary goes to stderr.
+ *
+ *   bench/desperateOverview_bench_kernels --min-time-ms 500 --out kernels.json
+ */
+
+#include "desperateOverview_capture_backend.h"
+#include "desperateOverview_config.h"
+#include "desperateOverview_core.h"
+#include "desperateOverview_core_ipc.h"
+#include "desperateOverview_core_state_internal.h"
+#include "desperateOverview_ui.h"
+#include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_thumb_cache.h"
+#include "yyjson.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef void (*KernelFn)(void *ctx);
+
+typedef struct {
+    const char *filter;
+    uint64_t min_time_ns;
+    FILE *out;
+    bool first_result;
+} BenchRun;
+
+typedef struct {
+    const char *name;
+    KernelFn fn;
+    void *ctx;
+    size_t bytes_per_op;
+} Kernel;
+
+static volatile uint64_t g_sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Runs the kernel in batches until min_time has passed and reports the
+ * mean and the best batch, which is less sensitive to scheduler noise. */
+static void run_kernel(BenchRun *run, const Kernel *k) {
+    if (run->filter && !strstr(k->name, run->filter))
+        return;
+
+    k->fn(k->ctx);
+
+    uint64_t batch = 1;
+    for (;;) {
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < batch; ++i)
+            k->fn(k->ctx);
+        uint64_t dt = now_ns() - t0;
+        if (dt >= run->min_time_ns / 10 || batch >= (1ull << 30))
+            break;
+        batch *= 2;
+    }
+
+    uint64_t total_ns = 0;
+    uint64_t total_iters = 0;
+    double best = 0.0;
+    while (total_ns < run->min_time_ns) {
+        uint64_t t0 = now_ns();
+        for (uint64_t i = 0; i < batch; ++i)
+            k->fn(k->ctx);
+        uint64_t dt = now_ns() - t0;
+        double per_op = (double)dt / (double)batch;
+        if (best == 0.0 || per_op < best)
+            best = per_op;
+        total_ns += dt;
+        total_iters += batch;
+    }
+
+    double mean = (double)total_ns / (double)total_iters;
+    fprintf(run->out, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, "
+                      "\"ns_per_op\": %.1f, \"best_ns_per_op\": %.1f",
+            run->first_result ? "" : ",", k->name,
+            (unsigned long long)total_iters, mean, best);
+    if (k->bytes_per_op > 0)
+        fprintf(run->out, ", \"mb_per_s\": %.1f", (double)k->bytes_per_op / mean * 1e3);
+    fprintf(run->out, "}");
+    run->first_result = false;
+
+    fprintf(stderr, "%-36s %12.1f ns/op", k->name, mean);
+    if (k->bytes_per_op > 0)
+        fprintf(stderr, " %10.1f MB/s", (double)k->bytes_per_op / mean * 1e3);
+    fprintf(stderr, "\n");
+}
+
+/* --- base64 ------------------------------------------------------------ */
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+} Base64Ctx;
+
+static void kernel_base64(void *ctx) {
+    Base64Ctx *c = ctx;
+    char *out = desperateOverview_capture_base64_encode(c->data, c->len);
+    g_sink += (uint64_t)(uintptr_t)out[0];
+    free(out);
+}
+
+/* --- downscale + PPM + base64 ------------------------------------------ */
+
+typedef struct {
+    DesperateOverviewCaptureFrame frame;
+    uint8_t *pixels;
+    uint32_t max_w;
+    int transform;
+} DownscaleCtx;
+
+static void downscale_ctx_init(DownscaleCtx *c, uint32_t w, uint32_t h, uint32_t max_w,
+                               int transform) {
+    c->pixels = malloc((size_t)w * h * 4);
+    for (size_t i = 0; i < (size_t)w * h * 4; ++i)
+        c->pixels[i] = (uint8_t)(i * 2654435761u >> 24);
+    c->frame = (DesperateOverviewCaptureFrame){
+        .width = w,
+        .height = h,
+        .stride = w * 4,
+        .pixels = c->pixels,
+        .backend_data = NULL,
+    };
+    c->max_w = max_w;
+    c->transform = transform;
+}
+
+static void kernel_downscale(void *ctx) {
+    DownscaleCtx *c = ctx;
+    char *out = desperateOverview_capture_frame_to_ppm_base64(&c->frame, c->max_w, c->transform);
+    g_sink += out ? (uint64_t)(uintptr_t)out[0] : 0;
+    free(out);
+}
+
+/* --- Hyprland JSON ------------------------------------------------------ */
+
+typedef struct {
+    char *monitors;
+    char *activeworkspace;
+    char *workspaces;
+    char *clients;
+    size_t clients_len;
+} FakeHyprState;
+
+static FakeHyprState g_fake;
+
+static char *build_clients_json(int windows, size_t *out_len) {
+    size_t cap = (size_t)windows * 512 + 64;
+    char *buf = malloc(cap);
+    size_t len = 0;
+    len += (size_t)snprintf(buf + len, cap - len, "[");
+    for (int i = 0; i < windows; ++i) {
+        int ws = 1 + i % (MAX_WS - 1);
+        len += (size_t)snprintf(buf + len, cap - len,
+            "%s{\"address\": \"0x%llx\", \"mapped\": true, \"hidden\": false, "
+            "\"at\": [%d, %d], \"size\": [%d, %d], "
+            "\"workspace\": {\"id\": %d, \"name\": \"%d\"}, \"floating\": false, "
+            "\"monitor\": 0, \"class\": \"class-%d\", \"title\": \"Window title %d\", "
+            "\"initialClass\": \"class-%d\", \"initialTitle\": \"Window title %d\", "
+            "\"pid\": %d, \"xwayland\": false, \"pinned\": false, \"fullscreen\": 0, "
+            "\"grouped\": [], \"tags\": [], \"swallowing\": \"0x0\", \"focusHistoryID\": %d}",
+            i ? "," : "", 0x55aa00001000ull + (unsigned long long)i * 0x40,
+            10 + (i % 4) * 470, 40 + (i % 3) * 340, 460, 330,
+            ws, ws, i % 13, i, i % 13, i, 1000 + i, i);
+    }
+    len += (size_t)snprintf(buf + len, cap - len, "]");
+    if (out_len)
+        *out_len = len;
+    return buf;
+}
+
+static void fake_state_init(int windows) {
+    free(g_fake.clients);
+    g_fake.monitors = g_fake.monitors ? g_fake.monitors : strdup(
+        "[{\"id\": 0, \"name\": \"FAKE-1\", \"width\": 1920, \"height\": 1080, "
+        "\"x\": 0, \"y\": 0, \"transform\": 0, \"focused\": true}]");
+    g_fake.activeworkspace = g_fake.activeworkspace ? g_fake.activeworkspace
+                                                    : strdup("{\"id\": 1, \"name\": \"1\"}");
+    g_fake.workspaces = g_fake.workspaces ? g_fake.workspaces : strdup("[]");
+    g_fake.clients = build_clients_json(windows, &g_fake.clients_len);
+}
+
+static char *fake_request(const char *request, size_t *out_len, void *user_data) {
+    (void)user_data;
+    const char *body = "[]";
+    if (strcmp(request, "j/monitors") == 0)
+        body = g_fake.monitors;
+    else if (strcmp(request, "j/activeworkspace") == 0)
+        body = g_fake.activeworkspace;
+    else if (strcmp(request, "j/workspaces") == 0)
+        body = g_fake.workspaces;
+    else if (strcmp(request, "j/clients") == 0)
+        body = g_fake.clients;
+    if (out_len)
+        *out_len = strlen(body);
+    return strdup(body);
+}
+
+static void kernel_json_read(void *ctx) {
+    (void)ctx;
+    yyjson_doc *doc = yyjson_read_opts(g_fake.clients, g_fake.clients_len,
+                                       YYJSON_READ_NOFLAG, NULL, NULL);
+    g_sink += doc ? yyjson_doc_get_read_size(doc) : 0;
+    yyjson_doc_free(doc);
+}
+
+static void kernel_core_refresh(void *ctx) {
+    (void)ctx;
+    desperateOverview_core_state_refresh_full();
+}
+
+/* --- state copies ------------------------------------------------------- */
+
+static void kernel_core_copy_state(void *ctx) {
+    CoreState *state = ctx;
+    desperateOverview_core_copy_state(state);
+    g_sink += (uint64_t)state->active_count;
+}
+
+static void kernel_ui_sync(void *ctx) {
+    (void)ctx;
+    desperateOverview_ui_sync_with_core();
+    g_sink += (uint64_t)g_active_count;
+}
+
+/* --- thumb cache crc ---------------------------------------------------- */
+
+static void kernel_thumb_crc(void *ctx) {
+    g_sink += desperateOverview_thumb_cache_crc(ctx);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --filter SUBSTR    only run kernels whose name contains SUBSTR\n"
+            "  --min-time-ms N    measuring time per kernel (default 300)\n"
+            "  --out FILE         write JSON to FILE instead of stdout\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    BenchRun run = {
+        .filter = NULL,
+        .min_time_ns = 300ull * 1000000ull,
+        .out = stdout,
+        .first_result = true,
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            run.filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            run.min_time_ns = strtoull(argv[++i], NULL, 10) * 1000000ull;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            run.out = fopen(argv[++i], "w");
+            if (!run.out) {
+                perror("bench: --out");
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    config_init(NULL);
+    desperateOverview_core_ipc_set_request_override(fake_request, NULL);
+    desperateOverview_capture_set_backend(desperateOverview_capture_backend_synthetic());
+    desperateOverview_core_state_init();
+    desperateOverview_thumb_cache_init();
+
+    fprintf(run.out, "{\n  \"suite\": \"kernels\",\n  \"results\": [");
+
+    Base64Ctx b64_small = { .len = 64 * 1024 };
+    Base64Ctx b64_large = { .len = 1024 * 1024 };
+    b64_small.data = malloc(b64_small.len);
+    b64_large.data = malloc(b64_large.len);
+    for (size_t i = 0; i < b64_large.len; ++i) {
+        b64_large.data[i] = (unsigned char)(i * 131u);
+        if (i < b64_small.len)
+            b64_small.data[i] = (unsigned char)(i * 131u);
+    }
+    run_kernel(&run, &(Kernel){ "base64.encode_64k", kernel_base64, &b64_small, b64_small.len });
+    run_kernel(&run, &(Kernel){ "base64.encode_1m", kernel_base64, &b64_large, b64_large.len });
+
+    DownscaleCtx ds_1080, ds_2160, ds_1080_rot;
+    downscale_ctx_init(&ds_1080, 1920, 1080, 512, 0);
+    downscale_ctx_init(&ds_2160, 3840, 2160, 512, 0);
+    downscale_ctx_init(&ds_1080_rot, 1920, 1080, 512, 1);
+    run_kernel(&run, &(Kernel){ "capture.ppm_b64_1080p_to_512", kernel_downscale, &ds_1080,
+                                (size_t)1920 * 1080 * 4 });
+    run_kernel(&run, &(Kernel){ "capture.ppm_b64_2160p_to_512", kernel_downscale, &ds_2160,
+                                (size_t)3840 * 2160 * 4 });
+    run_kernel(&run, &(Kernel){ "capture.ppm_b64_1080p_to_512_rot90", kernel_downscale, &ds_1080_rot,
+                                (size_t)1920 * 1080 * 4 });
+
+    desperateOverview_core_set_thumbnail_capture_enabled(false);
+    static const int kWindowCounts[] = { 100, 1000 };
+    for (size_t i = 0; i < sizeof(kWindowCounts) / sizeof(kWindowCounts[0]); ++i) {
+        char name[64];
+        fake_state_init(kWindowCounts[i]);
+        snprintf(name, sizeof(name), "json.read_clients_%d", kWindowCounts[i]);
+        run_kernel(&run, &(Kernel){ name, kernel_json_read, NULL, g_fake.clients_len });
+        snprintf(name, sizeof(name), "core.refresh_no_capture_%d", kWindowCounts[i]);
+        run_kernel(&run, &(Kernel){ name, kernel_core_refresh, NULL, g_fake.clients_len });
+    }
+
+    /* Copies are measured with real-sized thumbnails attached. */
+    DesperateOverviewSyntheticCaptureConfig synth = {
+        .width = 640, .height = 360, .latency_ms = 0, .failure_rate = 0.0, .seed = 1,
+    };
+    desperateOverview_capture_synthetic_configure(&synth);
+    desperateOverview_core_set_thumbnail_capture_enabled(true);
+    fake_state_init(200);
+    desperateOverview_core_state_refresh_full();
+
+    CoreState *copy = calloc(1, sizeof(*copy));
+    run_kernel(&run, &(Kernel){ "core.copy_state_200", kernel_core_copy_state, copy, 0 });
+    g_force_decode_thumbs = FALSE;
+    run_kernel(&run, &(Kernel){ "ui.sync_no_decode_200", kernel_ui_sync, NULL, 0 });
+    g_force_decode_thumbs = TRUE;
+    run_kernel(&run, &(Kernel){ "ui.sync_decode_200", kernel_ui_sync, NULL, 0 });
+    g_force_decode_thumbs = FALSE;
+
+    char *thumb = copy->workspaces[1].count > 0 ? copy->workspaces[1].wins[0].thumb_b64 : NULL;
+    if (thumb) {
+        run_kernel(&run, &(Kernel){ "thumb_cache.crc", kernel_thumb_crc, thumb, strlen(thumb) });
+    }
+
+    fprintf(run.out, "\n  ]\n}\n");
+    if (run.out != stdout)
+        fclose(run.out);
+
+    desperateOverview_core_free_state(copy);
+    free(copy);
+    free(b64_small.data);
+    free(b64_large.data);
+    free(ds_1080.pixels);
+    free(ds_2160.pixels);
+    free(ds_1080_rot.pixels);
+    desperateOverview_core_ipc_set_request_override(NULL, NULL);
+    desperateOverview_thumb_cache_shutdown();
+    desperateOverview_core_state_shutdown();
+    config_shutdown();
+    return 0;
+}
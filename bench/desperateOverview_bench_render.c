@@ -0,0 +1,337 @@
+#define _GNU_SOURCE
+
+/*
+ * Headless rendering benchmark. Fills the UI globals with synthetic
+ * workspaces and thumbnails, renders workspace cells and the current
+ * workspace preview into cairo image surfaces at several sizes, window
+ * counts and monitor transforms, and reports ms per frame. Each rendered
+ * frame is compared against bench/golden/<case>.png; a missing or
+ * differing reference fails the run, and --update-golden (re)writes them.
+ * Colors come from the built-in defaults unless --config is given, so
+ * goldens do not depend on the user's config.
+ * Timed frames reuse the scaled-surface cache like repeated redraws in the
+ * overlay; --no-surface-cache rescales every preview on every frame and
+ * --no-cell-layers re-renders cells instead of blitting their layer.
+ *
+ *   bench/desperateOverview_bench_render --frames 200
+ *   bench/desperateOverview_bench_render --update-golden
+ *   bench/desperateOverview_bench_render --no-surface-cache --no-cell-layers
+ */
+
+#include "desperateOverview_config.h"
+#include "desperateOverview_ui_render.h"
+#include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_surface_cache.h"
+
+#include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RENDER_WSID        1
+#define GOLDEN_TOLERANCE   2      /* per-channel difference that still matches */
+#define GOLDEN_MAX_BAD_PPM 500    /* mismatching pixels allowed, per million */
+
+typedef enum {
+    RENDER_CELL,
+    RENDER_CURRENT,
+} RenderKind;
+
+typedef struct {
+    RenderKind kind;
+    int width;
+    int height;
+} RenderSize;
+
+typedef struct {
+    const char *golden_dir;
+    int frames;
+    bool update_golden;
+    const char *filter;
+    bool surface_cache;
+    bool cell_layers;
+} RenderOptions;
+
+static const RenderSize kSizes[] = {
+    { RENDER_CELL, 240, 150 },
+    { RENDER_CELL, 480, 300 },
+    { RENDER_CURRENT, 1280, 720 },
+    { RENDER_CURRENT, 1920, 1080 },
+};
+static const int kWindowCounts[] = { 1, 8, MAX_WINS_PER_WS };
+static const int kTransforms[] = { 0, 1, 2, 3 };
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Thumbnails come out of capture already in display orientation, so a
+ * rotated monitor gets portrait ones. */
+static GdkPixbuf *make_thumbnail(int index, int transform) {
+    const int w = (transform % 2) ? 288 : 512;
+    const int h = (transform % 2) ? 512 : 288;
+    GdkPixbuf *pb = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, w, h);
+    if (!pb)
+        return NULL;
+    guchar *pixels = gdk_pixbuf_get_pixels(pb);
+    int stride = gdk_pixbuf_get_rowstride(pb);
+    for (int y = 0; y < h; ++y) {
+        guchar *row = pixels + (size_t)y * stride;
+        for (int x = 0; x < w; ++x) {
+            gboolean checker = (((x / 32) + (y / 32)) & 1) != 0;
+            row[x * 3 + 0] = (guchar)(index * 53 + x / 2);
+            row[x * 3 + 1] = (guchar)(index * 97 + y / 2 + (checker ? 40 : 0));
+            row[x * 3 + 2] = (guchar)(index * 31 + (x ^ y));
+        }
+    }
+    return pb;
+}
+
+static void clear_workspace(void) {
+    WorkspaceWindows *ws = &g_ws[RENDER_WSID];
+    for (int i = 0; i < ws->count; ++i) {
+        if (ws->wins[i].thumb_pixbuf)
+            g_object_unref(ws->wins[i].thumb_pixbuf);
+    }
+    memset(ws, 0, sizeof(*ws));
+}
+
+/* Tiles the monitor like a dwindle layout, then adds a couple of floating
+ * windows, so every case has overlapping and edge-touching rects. */
+static void setup_workspace(int count, int transform) {
+    clear_workspace();
+    desperateOverview_ui_render_invalidate_cells();
+
+    g_mon_id = 0;
+    g_mon_width = 2560;
+    g_mon_height = 1440;
+    g_mon_off_x = 0;
+    g_mon_off_y = 0;
+    g_mon_transform = transform;
+    g_active_workspace = RENDER_WSID;
+    g_active_list[0] = RENDER_WSID;
+    g_active_count = 1;
+
+    WorkspaceWindows *ws = &g_ws[RENDER_WSID];
+    snprintf(ws->name, sizeof(ws->name), "%d", RENDER_WSID);
+
+    int x = 10, y = 40, w = g_mon_width - 20, h = g_mon_height - 50;
+    for (int i = 0; i < count; ++i) {
+        WindowInfo *win = &ws->wins[i];
+        snprintf(win->addr, sizeof(win->addr), "0x%x", 0x1000 + i);
+        win->thumb_pixbuf = make_thumbnail(i, transform);
+
+        if (i >= 2 && i % 7 == 0) {
+            win->x = 200 + (i * 37) % 1400;
+            win->y = 150 + (i * 53) % 700;
+            win->w = 640;
+            win->h = 400;
+            ws->count++;
+            continue;
+        }
+
+        bool last = (i == count - 1);
+        if (last || w < 80 || h < 80) {
+            win->x = x; win->y = y; win->w = w; win->h = h;
+        } else if (i % 2 == 0) {
+            win->x = x; win->y = y; win->w = w / 2 - 5; win->h = h;
+            x += w / 2 + 5;
+            w = w / 2 - 5;
+        } else {
+            win->x = x; win->y = y; win->w = w; win->h = h / 2 - 5;
+            y += h / 2 + 5;
+            h = h / 2 - 5;
+        }
+        ws->count++;
+    }
+}
+
+static void render_once(cairo_t *cr, const RenderSize *size) {
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    if (size->kind == RENDER_CELL)
+        desperateOverview_ui_render_cell(cr, RENDER_WSID, size->width, size->height);
+    else
+        desperateOverview_ui_render_current_workspace(cr, size->width, size->height);
+}
+
+/* Returns 1 on match, 0 on mismatch, -1 when the golden is missing. */
+static int compare_golden(cairo_surface_t *surface, const char *path, double *bad_ppm) {
+    cairo_surface_t *golden = cairo_image_surface_create_from_png(path);
+    if (cairo_surface_status(golden) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(golden);
+        return -1;
+    }
+
+    int w = cairo_image_surface_get_width(surface);
+    int h = cairo_image_surface_get_height(surface);
+    if (cairo_image_surface_get_width(golden) != w ||
+        cairo_image_surface_get_height(golden) != h) {
+        cairo_surface_destroy(golden);
+        *bad_ppm = 1e6;
+        return 0;
+    }
+
+    cairo_surface_flush(surface);
+    const unsigned char *a = cairo_image_surface_get_data(surface);
+    const unsigned char *b = cairo_image_surface_get_data(golden);
+    int sa = cairo_image_surface_get_stride(surface);
+    int sb = cairo_image_surface_get_stride(golden);
+
+    uint64_t bad = 0;
+    for (int y = 0; y < h; ++y) {
+        const unsigned char *ra = a + (size_t)y * sa;
+        const unsigned char *rb = b + (size_t)y * sb;
+        for (int x = 0; x < w * 4; x += 4) {
+            for (int c = 0; c < 4; ++c) {
+                if (abs((int)ra[x + c] - (int)rb[x + c]) > GOLDEN_TOLERANCE) {
+                    bad++;
+                    break;
+                }
+            }
+        }
+    }
+    cairo_surface_destroy(golden);
+
+    *bad_ppm = (double)bad * 1e6 / ((double)w * (double)h);
+    return *bad_ppm <= GOLDEN_MAX_BAD_PPM ? 1 : 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --frames N         frames timed per case (default 100)\n"
+            "  --golden-dir DIR   reference images (default bench/golden)\n"
+            "  --update-golden    rewrite the reference images instead of comparing\n"
+            "  --filter SUBSTR    only run cases whose name contains SUBSTR\n"
+            "  --config PATH      render with this config instead of the defaults\n"
+            "  --no-surface-cache scale every preview on every frame\n"
+            "  --no-cell-layers   re-render cells instead of reusing their layer\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    RenderOptions opts = {
+        .golden_dir = "bench/golden",
+        .frames = 100,
+        .update_golden = false,
+        .filter = NULL,
+        .surface_cache = true,
+        .cell_layers = true,
+    };
+    const char *config_path = "/dev/null";
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--update-golden") == 0) {
+            opts.update_golden = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            opts.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--golden-dir") == 0 && i + 1 < argc) {
+            opts.golden_dir = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            opts.filter = argv[++i];
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-surface-cache") == 0) {
+            opts.surface_cache = false;
+        } else if (strcmp(argv[i], "--no-cell-layers") == 0) {
+            opts.cell_layers = false;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.frames <= 0)
+        opts.frames = 1;
+
+    config_init(config_path);
+    if (opts.surface_cache)
+        desperateOverview_surface_cache_init();
+    if (opts.update_golden)
+        g_mkdir_with_parents(opts.golden_dir, 0755);
+
+    int mismatches = 0;
+    int missing = 0;
+
+    printf("%-34s %10s %10s %8s\n", "case", "ms/frame", "best", "golden");
+    for (size_t s = 0; s < G_N_ELEMENTS(kSizes); ++s) {
+        const RenderSize *size = &kSizes[s];
+        for (size_t c = 0; c < G_N_ELEMENTS(kWindowCounts); ++c) {
+            for (size_t t = 0; t < G_N_ELEMENTS(kTransforms); ++t) {
+                char name[128];
+                snprintf(name, sizeof(name), "%s_%dx%d_w%d_t%d",
+                         size->kind == RENDER_CELL ? "cell" : "current",
+                         size->width, size->height, kWindowCounts[c], kTransforms[t]);
+                if (opts.filter && !strstr(name, opts.filter))
+                    continue;
+
+                setup_workspace(kWindowCounts[c], kTransforms[t]);
+                cairo_surface_t *surface = cairo_image_surface_create(
+                    CAIRO_FORMAT_ARGB32, size->width, size->height);
+                cairo_t *cr = cairo_create(surface);
+
+                render_once(cr, size);
+                uint64_t total = 0;
+                uint64_t best = UINT64_MAX;
+                for (int f = 0; f < opts.frames; ++f) {
+                    if (!opts.cell_layers)
+                        desperateOverview_ui_render_invalidate_cells();
+                    uint64_t t0 = now_ns();
+                    render_once(cr, size);
+                    cairo_surface_flush(surface);
+                    uint64_t dt = now_ns() - t0;
+                    total += dt;
+                    if (dt < best)
+                        best = dt;
+                }
+
+                char path[512];
+                snprintf(path, sizeof(path), "%s/%s.png", opts.golden_dir, name);
+                const char *verdict = "ok";
+                if (opts.update_golden) {
+                    verdict = cairo_surface_write_to_png(surface, path) == CAIRO_STATUS_SUCCESS
+                              ? "written" : "ERROR";
+                } else {
+                    double bad_ppm = 0.0;
+                    int rc = compare_golden(surface, path, &bad_ppm);
+                    if (rc < 0) {
+                        verdict = "missing";
+                        missing++;
+                    } else if (rc == 0) {
+                        verdict = "DIFF";
+                        mismatches++;
+                        fprintf(stderr, "%s: %.0f ppm of pixels differ from %s\n",
+                                name, bad_ppm, path);
+                    }
+                }
+
+                printf("%-34s %10.3f %10.3f %8s\n", name,
+                       (double)total / opts.frames / 1e6, (double)best / 1e6, verdict);
+
+                cairo_destroy(cr);
+                cairo_surface_destroy(surface);
+            }
+        }
+    }
+
+    clear_workspace();
+    desperateOverview_ui_render_invalidate_cells();
+    desperateOverview_surface_cache_shutdown();
+    config_shutdown();
+
+    if (missing > 0)
+        fprintf(stderr, "%d golden images missing; run with --update-golden to create them\n",
+                missing);
+    return (mismatches > 0 || missing > 0) ? 1 : 0;
+}
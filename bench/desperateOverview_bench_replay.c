@@ -0,0 +1,365 @@
+#define _GNU_SOURCE
+
+/*
+ * Replays a session recorded with `desperateOverview --record FILE` (or
+ * DESPERATEOVERVIEW_RECORD=FILE) through the core without Hyprland. Every
+ * recorded event that would trigger a refresh runs
+ * desperateOverview_core_state_refresh_full() against the recorded query
+ * replies, and per-stage timings are reported at the end. Thumbnails come
+ * from the synthetic capture backend.
+ *
+ *   bench/desperateOverview_bench_replay session.rec --speed 0 --repeat 5
+ */
+
+#include "desperateOverview_capture_backend.h"
+#include "desperateOverview_config.h"
+#include "desperateOverview_core.h"
+#include "desperateOverview_core_ipc.h"
+#include "desperateOverview_core_record.h"
+#include "desperateOverview_core_state_internal.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t t_ns;
+    char *body;
+    size_t len;
+} ReplayReply;
+
+typedef struct {
+    char *request;
+    ReplayReply *replies;
+    size_t count;
+} ReplayQuery;
+
+typedef struct {
+    uint64_t t_ns;
+    char *line;
+} ReplayEvent;
+
+typedef struct {
+    uint64_t *samples;
+    size_t count;
+    size_t cap;
+} StageSamples;
+
+static ReplayQuery *g_queries = NULL;
+static size_t g_query_count = 0;
+static ReplayEvent *g_events = NULL;
+static size_t g_event_count = 0;
+static atomic_uint_fast64_t g_replay_now_ns;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(ns / 1000000000ull),
+        .tv_nsec = (long)(ns % 1000000000ull),
+    };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+}
+
+/* Recordings made while the socket was unreachable carry the hyprctl
+ * command line as their key; fold them onto the socket request name. */
+static void normalize_request(const char *key, char *out, size_t out_len) {
+    const char *prefix = "hyprctl -j ";
+    if (strncmp(key, prefix, strlen(prefix)) == 0) {
+        const char *name = key + strlen(prefix);
+        size_t n = strcspn(name, " ");
+        snprintf(out, out_len, "j/%.*s", (int)n, name);
+        return;
+    }
+    snprintf(out, out_len, "%s", key);
+}
+
+static ReplayQuery *find_query(const char *request) {
+    for (size_t i = 0; i < g_query_count; ++i) {
+        if (strcmp(g_queries[i].request, request) == 0)
+            return &g_queries[i];
+    }
+    return NULL;
+}
+
+static int add_query(const DesperateOverviewRecordEntry *entry) {
+    char request[256];
+    normalize_request(entry->key, request, sizeof(request));
+
+    ReplayQuery *q = find_query(request);
+    if (!q) {
+        ReplayQuery *tmp = realloc(g_queries, (g_query_count + 1) * sizeof(*g_queries));
+        if (!tmp)
+            return -1;
+        g_queries = tmp;
+        q = &g_queries[g_query_count++];
+        memset(q, 0, sizeof(*q));
+        q->request = strdup(request);
+        if (!q->request)
+            return -1;
+    }
+
+    ReplayReply *tmp = realloc(q->replies, (q->count + 1) * sizeof(*q->replies));
+    if (!tmp)
+        return -1;
+    q->replies = tmp;
+    q->replies[q->count].t_ns = entry->t_ns;
+    q->replies[q->count].body = entry->payload;
+    q->replies[q->count].len = entry->payload_len;
+    q->count++;
+    return 0;
+}
+
+static int add_event(const DesperateOverviewRecordEntry *entry) {
+    ReplayEvent *tmp = realloc(g_events, (g_event_count + 1) * sizeof(*g_events));
+    if (!tmp)
+        return -1;
+    g_events = tmp;
+    g_events[g_event_count].t_ns = entry->t_ns;
+    g_events[g_event_count].line = entry->key;
+    g_event_count++;
+    return 0;
+}
+
+static int load_recording(const char *path) {
+    FILE *fp = desperateOverview_core_record_open(path);
+    if (!fp) {
+        fprintf(stderr, "replay: cannot open recording %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    DesperateOverviewRecordEntry entry;
+    int rc;
+    while ((rc = desperateOverview_core_record_read(fp, &entry)) > 0) {
+        int ok = -1;
+        if (entry.type == DESPERATEOVERVIEW_RECORD_QUERY) {
+            ok = add_query(&entry);
+            if (ok == 0) {
+                free(entry.key);
+                entry.key = NULL;
+                entry.payload = NULL;
+            }
+        } else if (entry.type == DESPERATEOVERVIEW_RECORD_EVENT) {
+            ok = add_event(&entry);
+            if (ok == 0)
+                entry.key = NULL;
+        } else {
+            ok = 0;
+        }
+        desperateOverview_core_record_entry_clear(&entry);
+        if (ok < 0) {
+            fclose(fp);
+            return -1;
+        }
+    }
+    fclose(fp);
+    if (rc < 0)
+        fprintf(stderr, "replay: %s is truncated, replaying what was read\n", path);
+    return 0;
+}
+
+/* Answers with the first reply recorded at or after the current replay time,
+ * i.e. the one the refresh triggered by the current event actually saw. */
+static char *replay_request(const char *request, size_t *out_len, void *user_data) {
+    (void)user_data;
+    const ReplayQuery *q = find_query(request);
+    const char *body = "[]";
+    size_t len = 2;
+
+    if (q && q->count > 0) {
+        uint64_t now = atomic_load(&g_replay_now_ns);
+        const ReplayReply *pick = &q->replies[q->count - 1];
+        for (size_t i = 0; i < q->count; ++i) {
+            if (q->replies[i].t_ns >= now) {
+                pick = &q->replies[i];
+                break;
+            }
+        }
+        body = pick->body;
+        len = pick->len;
+    }
+
+    char *copy = malloc(len + 1);
+    if (!copy)
+        return NULL;
+    memcpy(copy, body, len);
+    copy[len] = 0;
+    if (out_len)
+        *out_len = len;
+    return copy;
+}
+
+static void stage_add(StageSamples *s, uint64_t v) {
+    if (s->count == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 256;
+        uint64_t *tmp = realloc(s->samples, cap * sizeof(*tmp));
+        if (!tmp)
+            return;
+        s->samples = tmp;
+        s->cap = cap;
+    }
+    s->samples[s->count++] = v;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void stage_report(const char *name, StageSamples *s) {
+    if (s->count == 0) {
+        printf("%s.count 0\n", name);
+        return;
+    }
+    qsort(s->samples, s->count, sizeof(*s->samples), cmp_u64);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < s->count; ++i)
+        sum += s->samples[i];
+    size_t n = s->count;
+    printf("%s.count %zu\n", name, n);
+    printf("%s.mean_ms %.3f\n", name, (double)sum / (double)n / 1e6);
+    printf("%s.p50_ms %.3f\n", name, (double)s->samples[(n - 1) / 2] / 1e6);
+    printf("%s.p95_ms %.3f\n", name, (double)s->samples[(size_t)((double)(n - 1) * 0.95)] / 1e6);
+    printf("%s.p99_ms %.3f\n", name, (double)s->samples[(size_t)((double)(n - 1) * 0.99)] / 1e6);
+    printf("%s.max_ms %.3f\n", name, (double)s->samples[n - 1] / 1e6);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s RECORDING [options]\n"
+            "  --speed F              1 = original pacing, 4 = 4x faster, 0 = no waiting (default 0)\n"
+            "  --repeat N             replay the recording N times (default 1)\n"
+            "  --no-capture           skip thumbnail capture\n"
+            "  --capture-latency-ms N synthetic capture latency per window\n"
+            "  --capture-size WxH     synthetic frame size (default 1280x720)\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    double speed = 0.0;
+    int repeat = 1;
+    bool capture = true;
+    DesperateOverviewSyntheticCaptureConfig synth = {
+        .width = 1280,
+        .height = 720,
+        .latency_ms = 0,
+        .failure_rate = 0.0,
+        .seed = 1,
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--no-capture") == 0) {
+            capture = false;
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--capture-latency-ms") == 0 && i + 1 < argc) {
+            synth.latency_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--capture-size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &synth.width, &synth.height) != 2) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (repeat <= 0)
+        repeat = 1;
+    if (speed < 0.0)
+        speed = 0.0;
+
+    if (load_recording(path) < 0)
+        return 1;
+    printf("recording.events %zu\n", g_event_count);
+    printf("recording.query_kinds %zu\n", g_query_count);
+
+    config_init(NULL);
+    desperateOverview_capture_synthetic_configure(&synth);
+    desperateOverview_capture_set_backend(desperateOverview_capture_backend_synthetic());
+    desperateOverview_core_ipc_set_request_override(replay_request, NULL);
+    desperateOverview_core_state_init();
+    desperateOverview_core_set_thumbnail_capture_enabled(capture);
+
+    StageSamples fetch = {0}, parse = {0}, cap = {0}, total = {0};
+    size_t refreshes = 0;
+    uint64_t wall_start = now_ns();
+
+    for (int r = 0; r < repeat; ++r) {
+        atomic_store(&g_replay_now_ns, 0);
+        desperateOverview_core_state_refresh_full();
+
+        uint64_t pass_start = now_ns();
+        for (size_t i = 0; i < g_event_count; ++i) {
+            const ReplayEvent *ev = &g_events[i];
+            if (speed > 0.0) {
+                uint64_t due = pass_start + (uint64_t)((double)ev->t_ns / speed);
+                uint64_t now = now_ns();
+                if (due > now)
+                    sleep_ns(due - now);
+            }
+            if (!desperateOverview_core_ipc_event_line_requires_refresh(ev->line))
+                continue;
+
+            atomic_store(&g_replay_now_ns, ev->t_ns);
+            desperateOverview_core_state_refresh_full();
+
+            CoreRefreshTimings t;
+            desperateOverview_core_get_refresh_timings(&t);
+            stage_add(&fetch, t.fetch_ns);
+            stage_add(&parse, t.parse_ns);
+            stage_add(&cap, t.capture_ns);
+            stage_add(&total, t.total_ns);
+            refreshes++;
+        }
+    }
+
+    printf("replay.speed %.2f\n", speed);
+    printf("replay.repeat %d\n", repeat);
+    printf("replay.refreshes %zu\n", refreshes);
+    printf("replay.wall_ms %.3f\n", (double)(now_ns() - wall_start) / 1e6);
+    stage_report("fetch", &fetch);
+    stage_report("parse", &parse);
+    stage_report("capture", &cap);
+    stage_report("total", &total);
+
+    desperateOverview_core_ipc_set_request_override(NULL, NULL);
+    desperateOverview_core_state_shutdown();
+    config_shutdown();
+
+    free(fetch.samples);
+    free(parse.samples);
+    free(cap.samples);
+    free(total.samples);
+    for (size_t i = 0; i < g_query_count; ++i) {
+        for (size_t j = 0; j < g_queries[i].count; ++j)
+            free(g_queries[i].replies[j].body);
+        free(g_queries[i].replies);
+        free(g_queries[i].request);
+    }
+    free(g_queries);
+    for (size_t i = 0; i < g_event_count; ++i)
+        free(g_events[i].line);
+    free(g_events);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef DESPERATEOVERVIEW_CAPTURE_BACKEND_H
+#define DESPERATEOVERVIEW_CAPTURE_BACKEND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A grabbed frame in XRGB8888 (B, G, R, X byte order), owned by the backend
+ * until release() is called. */
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    const uint8_t *pixels;
+    void *backend_data;
+} DesperateOverviewCaptureFrame;
+
+typedef struct {
+    const char *name;
+    bool (*grab)(const char *addr_hex, DesperateOverviewCaptureFrame *out);
+    void (*release)(DesperateOverviewCaptureFrame *frame);
+} DesperateOverviewCaptureBackend;
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t latency_ms;
+    double   failure_rate;
+    uint32_t seed;
+} DesperateOverviewSyntheticCaptureConfig;
+
+const DesperateOverviewCaptureBackend *desperateOverview_capture_backend_wayland(void);
+const DesperateOverviewCaptureBackend *desperateOverview_capture_backend_synthetic(void);
+
+/* Passing NULL restores the backend selected by the config file. */
+void desperateOverview_capture_set_backend(const DesperateOverviewCaptureBackend *backend);
+const DesperateOverviewCaptureBackend *desperateOverview_capture_get_backend(void);
+
+/* Overrides the [capture] synthetic_* config keys; NULL restores them. */
+void desperateOverview_capture_synthetic_configure(const DesperateOverviewSyntheticCaptureConfig *cfg);
+
+/* Monitor transform applied while downscaling, so thumbnails are stored in
+ * display orientation and never rotated again at draw time. Flipped
+ * transforms (4-7) are treated as their plain quarter turn. */
+void desperateOverview_capture_set_display_transform(int transform);
+int  desperateOverview_capture_get_display_transform(void);
+
+/* Width refresh thumbnails are downscaled to, clamped to 64..1024; follows
+ * the on-screen cell size so small cells capture less and large grid cells
+ * get sharper thumbnails. Defaults to 512. */
+void     desperateOverview_capture_set_thumbnail_width(uint32_t max_w);
+uint32_t desperateOverview_capture_get_thumbnail_width(void);
+
+char *desperateOverview_capture_frame_to_ppm_base64(const DesperateOverviewCaptureFrame *frame,
+                                                    uint32_t max_w,
+                                                    int transform);
+char *desperateOverview_capture_base64_encode(const unsigned char *src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DESPERATEOVERVIEW_CAPTURE_BACKEND_H */
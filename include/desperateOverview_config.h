@@ -3,6 +3,12 @@
 
 #include <gtk/gtk.h>
 
+typedef enum {
+    OVERLAY_STRIP_FIT = 0,     /* shrink cells until every workspace fits */
+    OVERLAY_STRIP_SCROLL,      /* keep min_cell_width and scroll the strip */
+    OVERLAY_STRIP_GRID,        /* wrap cells into grid_columns columns */
+} OverlayStripMode;
+
 typedef struct {
     GdkRGBA inactive_ws_border;
     GdkRGBA active_ws_border;
@@ -16,10 +22,20 @@ typedef struct {
     GdkRGBA new_ws_background_hover;
     double  workspace_corner_radius;
     double  window_corner_radius;
+    OverlayStripMode strip_mode;
+    guint   min_cell_width;
+    guint   grid_columns;      /* 0 picks the column count with the largest cells */
     guint   drag_hold_delay_ms;
     guint   thumbnail_thread_count;
     gboolean follow_drop;
     double  fade_step;
+    gboolean synthetic_capture;
+    guint   synthetic_capture_width;
+    guint   synthetic_capture_height;
+    guint   synthetic_capture_latency_ms;
+    double  synthetic_capture_failure_rate;
+    gchar   trace_file[512];
+    gboolean hud_enabled;
 } OverlayConfig;
 
 void config_init(const char *override_path);
@@ -2,6 +2,7 @@
 #define DESPERATEOVERVIEW_CORE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,6 +12,9 @@ extern "C" {
 #define MAX_WINS_PER_WS 32
 #define CORE_WS_NAME_LEN 64
 
+/* Bit `wsid` of a capture mask selects that workspace. */
+#define CORE_CAPTURE_ALL_WORKSPACES UINT64_MAX
+
 typedef struct {
     int  x, y, w, h;
     char addr[64];
@@ -18,6 +22,10 @@ typedef struct {
     char *class_name;
     char *initial_class;
     char *title;
+    int  focus_history_id;        /* Hyprland focusHistoryID, 0 = focused, -1 unknown */
+    bool floating;
+    uint64_t capture_time_ns;     /* monotonic; 0 when there is no thumbnail */
+    uint64_t capture_latency_ns;
 } CoreWindow;
 
 typedef struct {
@@ -39,7 +47,19 @@ typedef struct {
     CoreWorkspace workspaces[MAX_WS];
 } CoreState;
 
+/* Wall-clock breakdown of the most recent full refresh. */
+typedef struct {
+    uint64_t fetch_ns;
+    uint64_t parse_ns;
+    uint64_t capture_ns;
+    uint64_t total_ns;
+} CoreRefreshTimings;
+
 typedef void (*CoreRedrawCallback)(void *user_data);
+/* Runs on the dispatching thread once the compositor answered a move of
+ * `count` windows; a batch succeeds or fails as a whole. */
+typedef void (*CoreMoveCallback)(const char *const *addrs, int count, int wsid, bool ok,
+                                 void *user_data);
 
 int  desperateOverview_core_init(CoreRedrawCallback cb, void *user_data);
 void desperateOverview_core_shutdown(void);
@@ -47,12 +67,26 @@ void desperateOverview_core_shutdown(void);
 void desperateOverview_core_copy_state(CoreState *out_state);
 void desperateOverview_core_free_state(CoreState *state);
 
-void desperateOverview_core_move_window(const char *addr, int wsid);
+bool desperateOverview_core_move_window(const char *addr, int wsid);
+/* Moves every window in one [[BATCH]] request (count <= MAX_WINS_PER_WS). */
+bool desperateOverview_core_move_windows(const char *const *addrs, int count, int wsid);
+/* Queues the moves for the core's move worker, which dispatches requests
+ * in call order and reports each outcome; desperateOverview_core_shutdown()
+ * drains the queue and joins the worker. */
+void desperateOverview_core_move_windows_async(const char *const *addrs, int count, int wsid,
+                                               CoreMoveCallback cb, void *user_data);
 void desperateOverview_core_switch_workspace(const char *name, int wsid);
 char *desperateOverview_core_capture_window_raw(const char *addr);
 void desperateOverview_core_set_thumbnail_capture_enabled(bool enabled);
+/* Limits refresh thumbnail capture to the workspaces in `mask`; windows
+ * elsewhere keep the thumbnail they already had. */
+void desperateOverview_core_set_capture_workspaces(uint64_t mask);
 void desperateOverview_core_request_full_refresh(void);
+/* Same as above on the core's refresh worker; requests made while a refresh
+ * runs are coalesced into one more. The redraw callback fires when done. */
+void desperateOverview_core_request_refresh_async(void);
 bool desperateOverview_core_state_needs_refresh(void);
+void desperateOverview_core_get_refresh_timings(CoreRefreshTimings *out);
 
 #ifdef __cplusplus
 }
@@ -1,11 +1,28 @@
 #ifndef DESPERATEOVERVIEW_CORE_IPC_H
 #define DESPERATEOVERVIEW_CORE_IPC_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 typedef void (*DesperateOverviewCoreRefreshHook)(void *user_data);
+typedef char *(*DesperateOverviewCoreRequestOverride)(const char *request, size_t *out_len,
+                                                      void *user_data);
 
 int  desperateOverview_core_ipc_init(void);
 void desperateOverview_core_ipc_shutdown(void);
+/* 0 when the command was written and not answered with an error. */
 int  desperateOverview_core_ipc_send_command(const char *command);
+/* Sends the commands as one [[BATCH]] request; 0 only if all were accepted. */
+int  desperateOverview_core_ipc_send_batch(const char *const *commands, int count);
+/* Sends a query such as "j/clients" over .socket.sock and returns the whole
+ * reply (NUL-terminated, caller frees), or NULL if the socket is unreachable
+ * or the reply does not arrive within 5 s. */
+char *desperateOverview_core_ipc_request(const char *request, size_t *out_len);
+/* Routes every request to fn instead of the socket (replay); NULL restores it. */
+void desperateOverview_core_ipc_set_request_override(DesperateOverviewCoreRequestOverride fn,
+                                                     void *user_data);
+/* True when a raw "event>>data" line would trigger a state refresh. */
+bool desperateOverview_core_ipc_event_line_requires_refresh(const char *line);
 
 int  desperateOverview_core_ipc_start_events(DesperateOverviewCoreRefreshHook hook,
                                              void *user_data);
@@ -0,0 +1,55 @@
+#ifndef DESPERATEOVERVIEW_CORE_RECORD_H
+#define DESPERATEOVERVIEW_CORE_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Session recording: every .socket2.sock event line and every query reply
+ * is appended to a file so a user's session can be replayed offline.
+ *
+ * File layout: the 8-byte magic "DOVREC01", then records of
+ *   u8  type ('E' event, 'Q' query)
+ *   u64 t_ns        (monotonic, relative to recording start)
+ *   u32 key_len     (event line or request string)
+ *   u32 payload_len (reply body; 0 for events)
+ *   key bytes, payload bytes
+ * with all integers little-endian.
+ */
+
+#define DESPERATEOVERVIEW_RECORD_EVENT 'E'
+#define DESPERATEOVERVIEW_RECORD_QUERY 'Q'
+
+typedef struct {
+    uint8_t  type;
+    uint64_t t_ns;
+    char    *key;      /* NUL-terminated */
+    uint32_t key_len;
+    char    *payload;  /* NUL-terminated, may be empty */
+    uint32_t payload_len;
+} DesperateOverviewRecordEntry;
+
+int  desperateOverview_core_record_start(const char *path);
+void desperateOverview_core_record_stop(void);
+bool desperateOverview_core_record_active(void);
+
+void desperateOverview_core_record_event(const char *line, size_t len);
+void desperateOverview_core_record_query(const char *request, const char *reply, size_t len);
+
+/* Reader side, used by the replay driver. read() returns 1 for an entry,
+ * 0 at end of file and -1 on a truncated or corrupt record. */
+FILE *desperateOverview_core_record_open(const char *path);
+int   desperateOverview_core_record_read(FILE *fp, DesperateOverviewRecordEntry *out);
+void  desperateOverview_core_record_entry_clear(DesperateOverviewRecordEntry *entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DESPERATEOVERVIEW_CORE_RECORD_H */
@@ -0,0 +1,99 @@
+#ifndef DESPERATEOVERVIEW_METRICS_H
+#define DESPERATEOVERVIEW_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Per-stage latency histograms. Recording is lock-free (relaxed atomics on
+ * log-linear buckets: four sub-buckets per power of two from 1us to ~34s),
+ * so it is safe from the event thread, capture workers and the GTK loop.
+ */
+
+typedef enum {
+    DESPERATEOVERVIEW_METRIC_REFRESH_FETCH = 0,
+    DESPERATEOVERVIEW_METRIC_REFRESH_PARSE,
+    DESPERATEOVERVIEW_METRIC_REFRESH_CAPTURE,
+    DESPERATEOVERVIEW_METRIC_REFRESH_TOTAL,
+    DESPERATEOVERVIEW_METRIC_CAPTURE_GRAB,     /* per window, backend grab */
+    DESPERATEOVERVIEW_METRIC_CAPTURE_ENCODE,   /* per window, downscale + PPM + base64 */
+    DESPERATEOVERVIEW_METRIC_UI_COPY,          /* core snapshot into the UI globals */
+    DESPERATEOVERVIEW_METRIC_THUMB_DECODE,     /* per thumbnail cache miss */
+    DESPERATEOVERVIEW_METRIC_LIVE_DECODE,
+    DESPERATEOVERVIEW_METRIC_PREVIEW_SCALE,    /* scale on a surface cache miss */
+    DESPERATEOVERVIEW_METRIC_OVERLAY_BUILD,    /* widget tree construction on show */
+    DESPERATEOVERVIEW_METRIC_DRAW_CELL,
+    DESPERATEOVERVIEW_METRIC_DRAW_CURRENT,
+    DESPERATEOVERVIEW_METRIC_EVENT_TO_UI,      /* refresh event read -> UI state updated */
+    DESPERATEOVERVIEW_METRIC_EVENT_TO_FRAME,   /* refresh event read -> next frame drawn */
+    DESPERATEOVERVIEW_METRIC_SHOW_TO_FRAME,    /* show request -> first frame drawn */
+    DESPERATEOVERVIEW_METRIC_ANIM_FRAME_INTERVAL, /* frame clock delta while animating */
+    DESPERATEOVERVIEW_METRIC_COUNT
+} DesperateOverviewMetric;
+
+/* Start timestamps carried across threads for the end-to-end metrics. A
+ * mark keeps the oldest pending start until it is taken. */
+typedef enum {
+    DESPERATEOVERVIEW_MARK_EVENT = 0,
+    DESPERATEOVERVIEW_MARK_EVENT_APPLIED,
+    DESPERATEOVERVIEW_MARK_SHOW,
+    DESPERATEOVERVIEW_MARK_COUNT
+} DesperateOverviewMark;
+
+typedef enum {
+    DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_HIT = 0,
+    DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_MISS,
+    DESPERATEOVERVIEW_COUNTER_CAPTURE_FAILED,
+    DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_HIT,
+    DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_MISS,
+    DESPERATEOVERVIEW_COUNTER_COUNT
+} DesperateOverviewCounter;
+
+typedef enum {
+    DESPERATEOVERVIEW_GAUGE_CAPTURES_IN_FLIGHT = 0,
+    DESPERATEOVERVIEW_GAUGE_LAST_REFRESH_NS,   /* monotonic time of the last full refresh */
+    DESPERATEOVERVIEW_GAUGE_COUNT
+} DesperateOverviewGauge;
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    uint64_t last_ns;
+} DesperateOverviewMetricSummary;
+
+uint64_t desperateOverview_metrics_now_ns(void);
+
+void desperateOverview_metrics_record(DesperateOverviewMetric metric, uint64_t ns);
+void desperateOverview_metrics_record_since(DesperateOverviewMetric metric, uint64_t start_ns);
+
+void     desperateOverview_metrics_mark_set(DesperateOverviewMark mark, uint64_t ns);
+uint64_t desperateOverview_metrics_mark_take(DesperateOverviewMark mark);
+
+void     desperateOverview_metrics_count(DesperateOverviewCounter counter);
+uint64_t desperateOverview_metrics_counter(DesperateOverviewCounter counter);
+void     desperateOverview_metrics_gauge_add(DesperateOverviewGauge gauge, int64_t delta);
+void     desperateOverview_metrics_gauge_set(DesperateOverviewGauge gauge, int64_t value);
+int64_t  desperateOverview_metrics_gauge(DesperateOverviewGauge gauge);
+
+const char *desperateOverview_metrics_name(DesperateOverviewMetric metric);
+void desperateOverview_metrics_get(DesperateOverviewMetric metric,
+                                   DesperateOverviewMetricSummary *out);
+void desperateOverview_metrics_reset(void);
+
+/* Prometheus text exposition of every stage, counter and gauge; caller
+ * frees. The HUD reads the same values through the getters above. */
+char *desperateOverview_metrics_format_prometheus(size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DESPERATEOVERVIEW_METRICS_H */
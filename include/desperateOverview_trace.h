@@ -0,0 +1,56 @@
+#ifndef DESPERATEOVERVIEW_TRACE_H
+#define DESPERATEOVERVIEW_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Opt-in span tracer. Each thread appends complete spans to its own buffer
+ * without locking; desperateOverview_trace_stop() writes every buffer as a
+ * Chrome trace-event JSON file that loads in Perfetto or chrome://tracing.
+ *
+ * While tracing is off, begin() is one relaxed atomic load and end() a
+ * branch on its zero result:
+ *
+ *   uint64_t span = desperateOverview_trace_begin();
+ *   ...
+ *   desperateOverview_trace_end("refresh_full", span, NULL);
+ *
+ * `name` must be a string literal (only the pointer is stored); `detail` is
+ * copied and may be NULL.
+ */
+
+extern atomic_bool desperateOverview_trace_enabled;
+
+uint64_t desperateOverview_trace_now_ns(void);
+void     desperateOverview_trace_emit(const char *name, uint64_t start_ns, const char *detail);
+
+static inline uint64_t desperateOverview_trace_begin(void) {
+    if (!atomic_load_explicit(&desperateOverview_trace_enabled, memory_order_relaxed))
+        return 0;
+    return desperateOverview_trace_now_ns();
+}
+
+static inline void desperateOverview_trace_end(const char *name, uint64_t start_ns,
+                                               const char *detail) {
+    if (start_ns)
+        desperateOverview_trace_emit(name, start_ns, detail);
+}
+
+/* Starts tracing into `path`; only one trace per process. */
+int  desperateOverview_trace_start(const char *path);
+void desperateOverview_trace_stop(void);
+
+/* Labels the calling thread in the trace (no-op while tracing is off). */
+void desperateOverview_trace_set_thread_name(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DESPERATEOVERVIEW_TRACE_H */
@@ -16,8 +16,12 @@ typedef struct {
     char *class_name;
     char *initial_class;
     char *title;
+    int  focus_history_id;
+    gboolean floating;
     guint32 thumb_crc;
     guint64 live_cookie;
+    guint64 capture_time_ns;      /* when the newest thumbnail or live frame was taken */
+    guint64 capture_latency_ns;
     double top_preview_x, top_preview_y, top_preview_w, top_preview_h;
     gboolean top_preview_valid;
     double bottom_preview_x, bottom_preview_y, bottom_preview_w, bottom_preview_h;
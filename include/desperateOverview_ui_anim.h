@@ -0,0 +1,36 @@
+#ifndef DESPERATEOVERVIEW_UI_ANIM_H
+#define DESPERATEOVERVIEW_UI_ANIM_H
+
+#include <gtk/gtk.h>
+
+/* Small animation engine on the widget frame clock. Animations step once
+ * per compositor frame through a tick callback that exists only while at
+ * least one animation on the widget is running. */
+
+typedef enum {
+    DESPERATEOVERVIEW_EASE_LINEAR = 0,
+    DESPERATEOVERVIEW_EASE_OUT_CUBIC,
+    DESPERATEOVERVIEW_EASE_IN_OUT_CUBIC,
+} DesperateOverviewEasing;
+
+/* `value` is the eased progress in [0, 1]. */
+typedef void (*DesperateOverviewAnimStep)(double value, gpointer user_data);
+/* `finished` is FALSE when the animation was cancelled or its widget went
+ * away; the widget must not be touched in that case. */
+typedef void (*DesperateOverviewAnimDone)(gboolean finished, gpointer user_data);
+
+double desperateOverview_anim_ease(DesperateOverviewEasing easing, double t);
+
+/* Returns an id > 0, or 0 if the widget cannot animate; `done` is not
+ * called in that case. The first step runs on the next frame with 0. */
+guint desperateOverview_anim_start(GtkWidget *widget,
+                                   guint duration_ms,
+                                   DesperateOverviewEasing easing,
+                                   DesperateOverviewAnimStep step,
+                                   DesperateOverviewAnimDone done,
+                                   gpointer user_data);
+void     desperateOverview_anim_cancel(guint id);
+void     desperateOverview_anim_cancel_widget(GtkWidget *widget);
+gboolean desperateOverview_anim_is_running(guint id);
+
+#endif /* DESPERATEOVERVIEW_UI_ANIM_H */
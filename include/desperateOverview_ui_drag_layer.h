@@ -0,0 +1,18 @@
+#ifndef DESPERATEOVERVIEW_UI_DRAG_LAYER_H
+#define DESPERATEOVERVIEW_UI_DRAG_LAYER_H
+
+#include <gtk/gtk.h>
+
+/* Pass-through drawing area over the whole overlay that paints the drag
+ * feedback: the dragged window's highlight in its cell and in the current
+ * preview, and the frame around the strip cell under the pointer. The
+ * cells and the current preview never draw it, so their cached layers
+ * stay valid for the whole drag. */
+void desperateOverview_ui_drag_layer_attach(GtkWidget *root_overlay);
+void desperateOverview_ui_drag_layer_detach(void);
+
+/* Damages the feedback drawn last and the feedback for the current drag
+ * state; call after the drag starts, ends or changes its drop target. */
+void desperateOverview_ui_drag_layer_update(void);
+
+#endif /* DESPERATEOVERVIEW_UI_DRAG_LAYER_H */
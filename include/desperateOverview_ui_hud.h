@@ -0,0 +1,16 @@
+#ifndef DESPERATEOVERVIEW_UI_HUD_H
+#define DESPERATEOVERVIEW_UI_HUD_H
+
+#include <gtk/gtk.h>
+
+/* Debug HUD drawn over the overlay from the desperateOverview_metrics
+ * counters, so screenshots show the same numbers as the STATS command. */
+void     desperateOverview_ui_hud_attach(GtkWidget *root_overlay);
+void     desperateOverview_ui_hud_detach(void);
+void     desperateOverview_ui_hud_toggle(void);
+gboolean desperateOverview_ui_hud_visible(void);
+
+/* Draws the HUD panel anchored to the top-right corner of a width x height area. */
+void     desperateOverview_ui_hud_render(cairo_t *cr, double width, double height);
+
+#endif /* DESPERATEOVERVIEW_UI_HUD_H */
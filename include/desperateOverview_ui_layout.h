@@ -5,6 +5,8 @@
 
 void desperateOverview_ui_build_overlay_content(GtkWidget *root_box);
 void desperateOverview_ui_rebuild_overlay_content(void);
+/* Sets the refresh capture mask for the strip the overlay is about to show. */
+void desperateOverview_ui_layout_prime_capture(void);
 
 #endif /* DESPERATEOVERVIEW_UI_LAYOUT_H */
 
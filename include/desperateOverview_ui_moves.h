@@ -0,0 +1,27 @@
+#ifndef DESPERATEOVERVIEW_UI_MOVES_H
+#define DESPERATEOVERVIEW_UI_MOVES_H
+
+#include "desperateOverview_types.h"
+
+/* Moves a window to another listed workspace in the UI model right away,
+ * keeping its thumbnail, and dispatches the compositor move on a worker
+ * thread. Until a core snapshot shows the window on the target (or the
+ * move times out) every UI copy re-applies it; a rejected move is rolled
+ * back and followed by a refresh. */
+void desperateOverview_ui_move_window(const char *addr, int target_ws);
+/* Same for several windows: one model update, one redraw and one
+ * [[BATCH]] dispatch; a rejected batch is rolled back as a whole. */
+void desperateOverview_ui_move_windows(const char *const *addrs, int count, int target_ws);
+
+/* Windows picked with Ctrl+click, kept by address across UI copies.
+ * Toggle returns whether the window is selected afterwards; clear repaints
+ * the cells that showed the selection. */
+gboolean desperateOverview_ui_selection_toggle(const WindowInfo *win);
+gboolean desperateOverview_ui_selection_contains(const WindowInfo *win);
+int      desperateOverview_ui_selection_get(const char **addrs, int max);
+void     desperateOverview_ui_selection_clear(void);
+
+/* Called by the UI copy once g_ws holds a new snapshot. */
+void desperateOverview_ui_moves_reconcile(void);
+
+#endif /* DESPERATEOVERVIEW_UI_MOVES_H */
@@ -0,0 +1,51 @@
+#ifndef DESPERATEOVERVIEW_UI_PREVIEW_LAYOUT_H
+#define DESPERATEOVERVIEW_UI_PREVIEW_LAYOUT_H
+
+#include <glib.h>
+
+#include "desperateOverview_types.h"
+
+/* Buckets per side of a layout's hit-test grid. */
+#define DESPERATEOVERVIEW_PREVIEW_GRID 8
+
+/* Window preview rects of one view in stacking order, bottom-most first.
+ * Laid out once per UI state and view size; draw and hit testing only
+ * read them. */
+typedef struct {
+    float x, y, w, h;
+    int   index;                /* into g_ws[wsid].wins */
+} DesperateOverviewPreviewSlot;
+
+typedef struct {
+    int     wsid;
+    double  width, height;
+    guint64 generation;
+    /* Workspace frame inside the view; the whole cell for strip cells. */
+    double  frame_x, frame_y, frame_w, frame_h;
+    int     count;
+    DesperateOverviewPreviewSlot slots[MAX_WINS_PER_WS];
+    /* Uniform grid over width x height: bit i of a bucket is set when
+     * slot i overlaps it. */
+    guint32 grid[DESPERATEOVERVIEW_PREVIEW_GRID * DESPERATEOVERVIEW_PREVIEW_GRID];
+} DesperateOverviewPreviewLayout;
+
+/* Marks every layout stale; called whenever g_ws or the monitor changes. */
+void desperateOverview_ui_preview_layout_invalidate(void);
+
+/* Layout of wsid's strip cell at width x height, and of the active
+ * workspace in the current preview. Recomputed only when stale or resized;
+ * NULL for an invalid workspace or an empty size. Each pass also mirrors
+ * the rects into the WindowInfo top_/bottom_preview fields used for damage. */
+const DesperateOverviewPreviewLayout *desperateOverview_ui_preview_layout_cell(int wsid, double width, double height);
+const DesperateOverviewPreviewLayout *desperateOverview_ui_preview_layout_current(double width, double height);
+
+/* Lays out every strip cell and the current preview at their present
+ * sizes, so damage and hit testing have rects before the next draw. */
+void desperateOverview_ui_preview_layout_refresh(void);
+
+/* Top-most window whose rect contains the point, or NULL. Looks only at
+ * the slots of the point's grid bucket. */
+WindowInfo *desperateOverview_ui_preview_layout_hit(const DesperateOverviewPreviewLayout *layout,
+                                                    double x, double y);
+
+#endif /* DESPERATEOVERVIEW_UI_PREVIEW_LAYOUT_H */
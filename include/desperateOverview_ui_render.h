@@ -6,8 +6,6 @@
 
 #include "desperateOverview_types.h"
 
-GdkPixbuf *desperateOverview_ui_orient_pixbuf(GdkPixbuf *src);
-
 void desperateOverview_ui_cache_window_preview(WindowInfo *win,
                                                double rx,
                                                double ry,
@@ -15,9 +13,30 @@ void desperateOverview_ui_cache_window_preview(WindowInfo *win,
                                                double rh,
                                                gboolean bottom_view);
 
+/* Widget-free renderers behind the draw callbacks below; they read the UI
+ * globals and draw into any cairo context of the given size. */
+void desperateOverview_ui_render_current_workspace(cairo_t *cr, double width, double height);
+void desperateOverview_ui_render_cell(cairo_t *cr, int wsid, double width, double height);
+
+/* Workspace cells keep their background and window previews in an
+ * offscreen layer that is re-rendered only when the workspace's windows,
+ * thumbnails or the cell size change; this drops every layer. */
+void desperateOverview_ui_render_invalidate_cells(void);
+
+/* Animation inputs: horizontal offset of the current-workspace preview as
+ * a fraction of its width, and a 0..1 highlight on a cell's border. */
+void desperateOverview_ui_render_set_current_slide(double offset);
+void desperateOverview_ui_render_set_cell_flash(int wsid, double alpha);
+
+/* Drag feedback painted by the drag layer: the highlight over a dragged
+ * window's preview rect, and the drop frame of a W x H cell at the origin. */
+void desperateOverview_ui_render_drag_window(cairo_t *cr, double x, double y, double w, double h);
+void desperateOverview_ui_render_drop_target(cairo_t *cr, double W, double H);
+
 gboolean desperateOverview_ui_draw_background(GtkWidget *widget, cairo_t *cr, gpointer data);
 gboolean desperateOverview_ui_draw_current_workspace(GtkWidget *widget, cairo_t *cr, gpointer data);
-gboolean desperateOverview_ui_draw_cell(GtkWidget *widget, cairo_t *cr, gpointer data);
+/* Draws every workspace cell of the strip that intersects the clip. */
+gboolean desperateOverview_ui_draw_strip(GtkWidget *widget, cairo_t *cr, gpointer data);
 
 #endif /* DESPERATEOVERVIEW_UI_RENDER_H */
 
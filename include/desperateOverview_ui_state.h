@@ -29,7 +29,7 @@ extern WorkspaceWindows g_ws[MAX_WS];
 extern int    g_active_list[MAX_WS];
 extern int    g_active_count;
 
-extern GtkWidget *g_cells[MAX_WS];
+extern GtkWidget *g_cell_strip;
 extern GtkWidget *g_overlay_window;
 extern GtkWidget *g_root_overlay;
 extern GtkWidget *g_root_box;
@@ -40,18 +40,23 @@ extern int g_built_active_count;
 extern int g_built_active_list[MAX_WS];
 extern char g_built_active_names[MAX_WS][CORE_WS_NAME_LEN];
 extern gboolean g_overlay_visible;
-extern guint g_fade_source_id;
+extern guint g_fade_anim_id;
 
 extern const gchar g_drag_target_name[];
 extern const GtkTargetEntry g_drag_targets[];
 extern const size_t g_drag_targets_count;
 
-void desperateOverview_ui_queue_cells_redraw(void);
+/* Damages only the window's rect in its workspace cell (top) and/or in the
+ * current-workspace preview (bottom); use it when nothing else moved. */
+void desperateOverview_ui_queue_window_redraw(WindowInfo *win, gboolean top, gboolean bottom);
+int desperateOverview_ui_find_window_workspace(const WindowInfo *win);
 void desperateOverview_ui_refresh_active_workspace_view(int wsid);
 int desperateOverview_ui_find_active_index(int wsid);
 const char *desperateOverview_ui_workspace_display_name(int wsid);
 int desperateOverview_ui_get_effective_mon_width(void);
 int desperateOverview_ui_get_effective_mon_height(void);
+/* The GdkMonitor the overlay targets, or the primary one when none matches. */
+GdkMonitor *desperateOverview_ui_match_monitor(GdkDisplay *display);
 extern DragState g_drag;
 
 extern GMutex g_redraw_lock;
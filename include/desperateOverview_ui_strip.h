@@ -0,0 +1,37 @@
+#ifndef DESPERATEOVERVIEW_UI_STRIP_H
+#define DESPERATEOVERVIEW_UI_STRIP_H
+
+#include <gtk/gtk.h>
+
+/* The workspace strip is a single drawing area that lays out, draws and
+ * hit-tests one cell per entry of g_active_list, so building it, resizing
+ * it and dispatching its events cost the same for any workspace count.
+ * Cells are cell_w x cell_h, `gap` apart, filled row by row into `columns`
+ * columns (0 keeps them in one row). */
+GtkWidget *desperateOverview_ui_strip_new(void);
+void       desperateOverview_ui_strip_set_layout(double cell_w, double cell_h, double gap, int columns);
+void       desperateOverview_ui_strip_get_cell_size(double *cell_w, double *cell_h);
+void       desperateOverview_ui_strip_index_origin(int index, double *x, double *y);
+
+/* Workspace id under a strip position (-1 in a gap or outside), with the
+ * position translated into that cell's coordinates. */
+int        desperateOverview_ui_strip_cell_at(double x, double y, double *cell_x, double *cell_y);
+gboolean   desperateOverview_ui_strip_cell_origin(int wsid, double *x, double *y);
+
+void       desperateOverview_ui_strip_queue_cell(int wsid);
+void       desperateOverview_ui_strip_queue_cell_area(int wsid, int x, int y, int w, int h);
+
+/* Scroll mode: the strip sits in a horizontal GtkScrolledWindow. Refresh
+ * thumbnail capture is limited to the cells in the viewport plus a few on
+ * each side, and newly reached cells trigger a background refresh. */
+void       desperateOverview_ui_strip_attach_scroller(GtkWidget *scroller);
+void       desperateOverview_ui_strip_scroll_to(int wsid);
+/* Captures thumbnails only for active-list indices first..last (and the
+ * active workspace), or for every workspace again. */
+void       desperateOverview_ui_strip_capture_range(int first, int last);
+void       desperateOverview_ui_strip_capture_all(void);
+
+/* Cell currently under a drag, -1 if none; drawn with the drop highlight. */
+int        desperateOverview_ui_strip_drop_target(void);
+
+#endif /* DESPERATEOVERVIEW_UI_STRIP_H */
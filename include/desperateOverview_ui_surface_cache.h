@@ -0,0 +1,46 @@
+#ifndef DESPERATEOVERVIEW_UI_SURFACE_CACHE_H
+#define DESPERATEOVERVIEW_UI_SURFACE_CACHE_H
+
+#include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib.h>
+
+/* A window is painted at one size in its workspace cell and at another in
+ * the current-workspace preview, so each window keeps one slot per view.
+ * The drag icon slot is filled by desperateOverview_surface_cache_get_drag_icon(). */
+typedef enum {
+    DESPERATEOVERVIEW_SURFACE_VIEW_CELL = 0,
+    DESPERATEOVERVIEW_SURFACE_VIEW_CURRENT,
+    DESPERATEOVERVIEW_SURFACE_VIEW_DRAG_ICON,
+    DESPERATEOVERVIEW_SURFACE_VIEW_COUNT
+} DesperateOverviewSurfaceView;
+
+void desperateOverview_surface_cache_init(void);
+void desperateOverview_surface_cache_shutdown(void);
+
+/* Returns a new reference to a surface holding `source` scaled to
+ * width x height, ready to paint. Thumbnails arrive in display orientation
+ * from the capture stage. The slot is rebuilt only when the source pixbuf,
+ * content_crc or size differ from the last call for this window and view. */
+cairo_surface_t *desperateOverview_surface_cache_get(const char *addr,
+                                                     DesperateOverviewSurfaceView view,
+                                                     GdkPixbuf *source,
+                                                     guint32 content_crc,
+                                                     int width,
+                                                     int height);
+
+/* Returns a new reference to the window's drag icon, each side clamped to
+ * min_dim..max_dim, with its device offset set so the pointer grabs it in
+ * the middle. The icon is scaled from the largest surface already cached
+ * for the cell or current view, never from the thumbnail, so its cost
+ * depends on the icon size only; it is kept until that surface changes.
+ * Returns a shared flat placeholder when the window has no cached surface. */
+cairo_surface_t *desperateOverview_surface_cache_get_drag_icon(const char *addr,
+                                                               int max_dim,
+                                                               int min_dim);
+
+/* Drops the entries of windows that are no longer in g_ws. */
+void desperateOverview_surface_cache_prune(void);
+void desperateOverview_surface_cache_clear(void);
+
+#endif /* DESPERATEOVERVIEW_UI_SURFACE_CACHE_H */
@@ -3,6 +3,7 @@
 #include <glib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <limits.h>
@@ -12,6 +13,10 @@
 #include <pthread.h>
 
 #include "desperateOverview_core.h"
+#include "desperateOverview_core_record.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
+#include "desperateOverview_config.h"
 #include "desperateOverview_ui.h"
 
 static pthread_t g_control_thread;
@@ -22,17 +27,34 @@ static char g_cli_config_path[PATH_MAX];
 static bool g_cli_config_path_set = false;
 static char g_cli_css_path[PATH_MAX];
 static bool g_cli_css_path_set = false;
+static char g_cli_record_path[PATH_MAX];
+static bool g_cli_record_path_set = false;
 
 #define CONTROL_SOCKET_PATH_FMT "/run/user/%d/desp_overview.sock"
 
 static int start_control_server(void);
 static void stop_control_server(void);
 static void *control_server_thread(void *data);
-static void handle_control_command(const char *cmd);
+static void handle_control_command(const char *cmd, int reply_fd);
 static int send_control_command(const char *cmd);
+static int query_control_command(const char *cmd);
 static bool notify_existing_instance(const char *cmd);
 
-static void handle_control_command(const char *cmd) {
+/* MSG_NOSIGNAL: a client that hangs up early must not kill the overlay. */
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = send(fd, buf, len, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        buf += w;
+        len -= (size_t)w;
+    }
+}
+
+static void handle_control_command(const char *cmd, int reply_fd) {
     if (!cmd || !*cmd)
         return;
 
@@ -48,6 +70,13 @@ static void handle_control_command(const char *cmd) {
     } else if (g_ascii_strcasecmp(cmd, "QUIT") == 0) {
         desperateOverview_ui_request_hide();
         desperateOverview_ui_request_quit();
+    } else if (g_ascii_strcasecmp(cmd, "STATS") == 0) {
+        size_t len = 0;
+        char *text = desperateOverview_metrics_format_prometheus(&len);
+        if (text) {
+            write_all(reply_fd, text, len);
+            free(text);
+        }
     }
 }
 
@@ -68,7 +97,7 @@ static void *control_server_thread(void *data) {
         if (r > 0) {
             buf[r] = 0;
             buf[strcspn(buf, "\r\n")] = 0;
-            handle_control_command(buf);
+            handle_control_command(buf, cfd);
         }
         close(cfd);
     }
@@ -163,6 +192,48 @@ static int send_control_command(const char *cmd) {
     return 0;
 }
 
+/* Sends a command and copies the reply to stdout until the server closes. */
+static int query_control_command(const char *cmd) {
+    char path[256];
+    snprintf(path, sizeof(path), CONTROL_SOCKET_PATH_FMT, getuid());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path),
+             "%.*s", (int)sizeof(addr.sun_path) - 1, path);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        close(fd);
+        return 1;
+    }
+
+    dprintf(fd, "%s\n", cmd);
+    shutdown(fd, SHUT_WR);
+
+    char buf[4096];
+    ssize_t r;
+    while ((r = read(fd, buf, sizeof(buf))) != 0) {
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("read");
+            close(fd);
+            return 1;
+        }
+        fwrite(buf, 1, (size_t)r, stdout);
+    }
+    close(fd);
+    return 0;
+}
+
 static bool notify_existing_instance(const char *cmd) {
     char path[256];
     snprintf(path, sizeof(path), CONTROL_SOCKET_PATH_FMT, getuid());
@@ -209,6 +280,14 @@ int main(int argc, char **argv) {
             snprintf(g_cli_css_path, sizeof(g_cli_css_path), "%s", argv[i + 1]);
             g_cli_css_path_set = true;
             ++i;
+        } else if (strcmp(argv[i], "--record") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "desperateOverview: --record requires a file path\n");
+                return 1;
+            }
+            snprintf(g_cli_record_path, sizeof(g_cli_record_path), "%s", argv[i + 1]);
+            g_cli_record_path_set = true;
+            ++i;
         } else if (strcmp(argv[i], "--toggle") == 0) {
             if (send_control_command("TOGGLE") == 0)
                 return 0;
@@ -223,6 +302,8 @@ int main(int argc, char **argv) {
             return send_control_command("QUIT");
         } else if (strcmp(argv[i], "--quit") == 0) {
             return send_control_command("QUIT");
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            return query_control_command("STATS");
         } else {
             fprintf(stderr, "Unknown option: %s\n", argv[i]);
             return 1;
@@ -241,7 +322,20 @@ int main(int argc, char **argv) {
     if (oneshot_mode)
         desperateOverview_ui_set_exit_on_hide(true);
 
+    const char *trace_path = getenv("DESPERATEOVERVIEW_TRACE");
+    if (!trace_path || !*trace_path)
+        trace_path = config_get()->trace_file;
+    if (trace_path && *trace_path && desperateOverview_trace_start(trace_path) == 0)
+        desperateOverview_trace_set_thread_name("gtk-main");
+
+    const char *record_path = g_cli_record_path_set ? g_cli_record_path
+                                                    : getenv("DESPERATEOVERVIEW_RECORD");
+    if (record_path && *record_path && desperateOverview_core_record_start(record_path) != 0)
+        fprintf(stderr, "desperateOverview: recording to %s disabled\n", record_path);
+
     if (desperateOverview_core_init(desperateOverview_ui_core_redraw_callback, NULL) != 0) {
+        desperateOverview_core_record_stop();
+        desperateOverview_trace_stop();
         desperateOverview_ui_shutdown();
         return 1;
     }
@@ -251,6 +345,8 @@ int main(int argc, char **argv) {
     if (!oneshot_mode) {
         if (start_control_server() != 0) {
             desperateOverview_core_shutdown();
+            desperateOverview_core_record_stop();
+            desperateOverview_trace_stop();
             desperateOverview_ui_shutdown();
             return 1;
         }
@@ -265,6 +361,8 @@ int main(int argc, char **argv) {
     if (control_server_started)
         stop_control_server();
     desperateOverview_core_shutdown();
+    desperateOverview_core_record_stop();
+    desperateOverview_trace_stop();
     desperateOverview_ui_shutdown();
     return 0;
 }
@@ -0,0 +1,147 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_capture_backend.h"
+#include "desperateOverview_config.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SYNTHETIC_DEFAULT_W 1280
+#define SYNTHETIC_DEFAULT_H 720
+#define SYNTHETIC_MAX_DIM   8192
+
+static bool synthetic_grab(const char *addr_hex, DesperateOverviewCaptureFrame *out);
+static void synthetic_release(DesperateOverviewCaptureFrame *frame);
+
+static const DesperateOverviewCaptureBackend g_synthetic_backend = {
+    .name = "synthetic",
+    .grab = synthetic_grab,
+    .release = synthetic_release,
+};
+
+static pthread_mutex_t g_synthetic_lock = PTHREAD_MUTEX_INITIALIZER;
+static DesperateOverviewSyntheticCaptureConfig g_synthetic_override;
+static bool g_synthetic_override_set = false;
+static atomic_uint_fast64_t g_synthetic_sequence;
+
+const DesperateOverviewCaptureBackend *desperateOverview_capture_backend_synthetic(void) {
+    return &g_synthetic_backend;
+}
+
+void desperateOverview_capture_synthetic_configure(const DesperateOverviewSyntheticCaptureConfig *cfg) {
+    pthread_mutex_lock(&g_synthetic_lock);
+    if (cfg) {
+        g_synthetic_override = *cfg;
+        g_synthetic_override_set = true;
+    } else {
+        memset(&g_synthetic_override, 0, sizeof(g_synthetic_override));
+        g_synthetic_override_set = false;
+    }
+    atomic_store(&g_synthetic_sequence, 0);
+    pthread_mutex_unlock(&g_synthetic_lock);
+}
+
+static void synthetic_current_config(DesperateOverviewSyntheticCaptureConfig *out) {
+    pthread_mutex_lock(&g_synthetic_lock);
+    if (g_synthetic_override_set) {
+        *out = g_synthetic_override;
+    } else {
+        const OverlayConfig *cfg = config_get();
+        out->width = cfg ? cfg->synthetic_capture_width : 0;
+        out->height = cfg ? cfg->synthetic_capture_height : 0;
+        out->latency_ms = cfg ? cfg->synthetic_capture_latency_ms : 0;
+        out->failure_rate = cfg ? cfg->synthetic_capture_failure_rate : 0.0;
+        out->seed = 0;
+    }
+    pthread_mutex_unlock(&g_synthetic_lock);
+
+    if (out->width == 0 || out->width > SYNTHETIC_MAX_DIM)
+        out->width = SYNTHETIC_DEFAULT_W;
+    if (out->height == 0 || out->height > SYNTHETIC_MAX_DIM)
+        out->height = SYNTHETIC_DEFAULT_H;
+}
+
+/* splitmix64: cheap, stateless and good enough to spread address bits. */
+static uint64_t synthetic_mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static void synthetic_sleep_ms(uint32_t ms) {
+    if (ms == 0)
+        return;
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000L,
+    };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+}
+
+static bool synthetic_grab(const char *addr_hex, DesperateOverviewCaptureFrame *out) {
+    DesperateOverviewSyntheticCaptureConfig cfg;
+    synthetic_current_config(&cfg);
+
+    uint64_t addr = strtoull(addr_hex, NULL, 16);
+    uint64_t key = synthetic_mix(addr ^ ((uint64_t)cfg.seed << 32));
+    uint64_t seq = atomic_fetch_add(&g_synthetic_sequence, 1);
+
+    synthetic_sleep_ms(cfg.latency_ms);
+
+    if (cfg.failure_rate > 0.0) {
+        double roll = (double)(synthetic_mix(key ^ seq) >> 11) / (double)(1ULL << 53);
+        if (roll < cfg.failure_rate)
+            return false;
+    }
+
+    uint32_t w = cfg.width;
+    uint32_t h = cfg.height;
+    uint32_t stride = w * 4;
+    uint8_t *pixels = malloc((size_t)stride * h);
+    if (!pixels)
+        return false;
+
+    /* Per-window base colour plus a gradient and a block grid, so downscaled
+     * output differs between windows and is not trivially compressible. */
+    uint8_t base_r = (uint8_t)(key);
+    uint8_t base_g = (uint8_t)(key >> 8);
+    uint8_t base_b = (uint8_t)(key >> 16);
+    uint32_t block = 16 + (uint32_t)((key >> 24) & 0x1f);
+
+    for (uint32_t y = 0; y < h; ++y) {
+        uint8_t *row = pixels + (size_t)y * stride;
+        uint8_t gy = (uint8_t)((y * 255u) / (h > 1 ? h - 1 : 1));
+        for (uint32_t x = 0; x < w; ++x) {
+            uint8_t gx = (uint8_t)((x * 255u) / (w > 1 ? w - 1 : 1));
+            bool checker = (((x / block) + (y / block)) & 1u) != 0;
+            uint8_t *p = row + (size_t)x * 4;
+            p[0] = (uint8_t)(base_b ^ gy);
+            p[1] = (uint8_t)(base_g + (checker ? 48 : 0));
+            p[2] = (uint8_t)(base_r ^ gx);
+            p[3] = 0xff;
+        }
+    }
+
+    out->width = w;
+    out->height = h;
+    out->stride = stride;
+    out->pixels = pixels;
+    out->backend_data = pixels;
+    return true;
+}
+
+static void synthetic_release(DesperateOverviewCaptureFrame *frame) {
+    if (!frame)
+        return;
+    free(frame->backend_data);
+    frame->backend_data = NULL;
+    frame->pixels = NULL;
+}
@@ -97,10 +97,20 @@ static void set_defaults(OverlayConfig *cfg) {
     cfg->new_ws_background_hover = lighten_color(&cfg->new_ws_background, 0.15);
     cfg->workspace_corner_radius = 10.0;
     cfg->window_corner_radius = 4.0;
+    cfg->strip_mode = OVERLAY_STRIP_FIT;
+    cfg->min_cell_width = 240;
+    cfg->grid_columns = 0;
     cfg->drag_hold_delay_ms = 150;
     cfg->thumbnail_thread_count = 4;
     cfg->fade_step = 0.08;
     cfg->follow_drop = FALSE;
+    cfg->synthetic_capture = FALSE;
+    cfg->synthetic_capture_width = 1280;
+    cfg->synthetic_capture_height = 720;
+    cfg->synthetic_capture_latency_ms = 0;
+    cfg->synthetic_capture_failure_rate = 0.0;
+    cfg->trace_file[0] = '\0';
+    cfg->hud_enabled = FALSE;
 }
 
 static gchar *default_config_path(void) {
@@ -149,6 +159,31 @@ static void load_from_file(const char *path, OverlayConfig *cfg) {
     if (local_err)
         g_clear_error(&local_err);
 
+    g_autofree gchar *strip_mode = g_key_file_get_string(kf, "layout", "strip_mode", NULL);
+    if (strip_mode) {
+        g_strstrip(strip_mode);
+        if (g_ascii_strcasecmp(strip_mode, "fit") == 0)
+            cfg->strip_mode = OVERLAY_STRIP_FIT;
+        else if (g_ascii_strcasecmp(strip_mode, "scroll") == 0)
+            cfg->strip_mode = OVERLAY_STRIP_SCROLL;
+        else if (g_ascii_strcasecmp(strip_mode, "grid") == 0)
+            cfg->strip_mode = OVERLAY_STRIP_GRID;
+        else
+            g_warning("desperateOverview config: unknown strip mode '%s'", strip_mode);
+    }
+
+    gint min_cell_width = g_key_file_get_integer(kf, "layout", "min_cell_width", &local_err);
+    if (!local_err && min_cell_width > 0)
+        cfg->min_cell_width = (guint)min_cell_width;
+    if (local_err)
+        g_clear_error(&local_err);
+
+    gint grid_columns = g_key_file_get_integer(kf, "layout", "grid_columns", &local_err);
+    if (!local_err && grid_columns >= 0)
+        cfg->grid_columns = (guint)grid_columns;
+    if (local_err)
+        g_clear_error(&local_err);
+
     gint drag_delay = g_key_file_get_integer(kf, "behavior", "drag_hold_delay_ms", &local_err);
     if (!local_err && drag_delay > 0)
         cfg->drag_hold_delay_ms = (guint)drag_delay;
@@ -173,6 +208,53 @@ static void load_from_file(const char *path, OverlayConfig *cfg) {
     if (local_err)
         g_clear_error(&local_err);
 
+    g_autofree gchar *capture_backend = g_key_file_get_string(kf, "capture", "backend", NULL);
+    if (capture_backend) {
+        g_strstrip(capture_backend);
+        if (g_ascii_strcasecmp(capture_backend, "synthetic") == 0)
+            cfg->synthetic_capture = TRUE;
+        else if (g_ascii_strcasecmp(capture_backend, "wayland") == 0)
+            cfg->synthetic_capture = FALSE;
+        else
+            g_warning("desperateOverview config: unknown capture backend '%s'", capture_backend);
+    }
+
+    gint synth_w = g_key_file_get_integer(kf, "capture", "synthetic_width", &local_err);
+    if (!local_err && synth_w > 0)
+        cfg->synthetic_capture_width = (guint)synth_w;
+    if (local_err)
+        g_clear_error(&local_err);
+
+    gint synth_h = g_key_file_get_integer(kf, "capture", "synthetic_height", &local_err);
+    if (!local_err && synth_h > 0)
+        cfg->synthetic_capture_height = (guint)synth_h;
+    if (local_err)
+        g_clear_error(&local_err);
+
+    gint synth_latency = g_key_file_get_integer(kf, "capture", "synthetic_latency_ms", &local_err);
+    if (!local_err && synth_latency >= 0)
+        cfg->synthetic_capture_latency_ms = (guint)synth_latency;
+    if (local_err)
+        g_clear_error(&local_err);
+
+    double synth_fail = g_key_file_get_double(kf, "capture", "synthetic_failure_rate", &local_err);
+    if (!local_err && synth_fail >= 0.0 && synth_fail <= 1.0)
+        cfg->synthetic_capture_failure_rate = synth_fail;
+    if (local_err)
+        g_clear_error(&local_err);
+
+    g_autofree gchar *trace_file = g_key_file_get_string(kf, "debug", "trace_file", NULL);
+    if (trace_file) {
+        g_strstrip(trace_file);
+        g_strlcpy(cfg->trace_file, trace_file, sizeof(cfg->trace_file));
+    }
+
+    gboolean hud = g_key_file_get_boolean(kf, "debug", "hud", &local_err);
+    if (!local_err)
+        cfg->hud_enabled = hud;
+    if (local_err)
+        g_clear_error(&local_err);
+
     g_key_file_unref(kf);
 }
 
@@ -3,6 +3,7 @@
 #include "desperateOverview_core.h"
 #include "desperateOverview_thumbnail_capture.h"
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,10 +12,28 @@
 #include "desperateOverview_core_ipc.h"
 #include "desperateOverview_core_state_internal.h"
 #include "desperateOverview_core_utils.h"
+#include "desperateOverview_trace.h"
 
 static CoreRedrawCallback g_redraw_cb = NULL;
 static void              *g_redraw_user = NULL;
 
+typedef struct CoreMoveRequest CoreMoveRequest;
+
+/* Async refreshes run on one lazily started worker; requests made while it
+ * is busy collapse into a single follow-up refresh. Async moves go through
+ * a second worker in FIFO order, so dispatches reach Hyprland in the order
+ * the drops happened. */
+static pthread_mutex_t g_worker_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_worker_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t       g_refresh_worker;
+static bool            g_refresh_worker_started = false;
+static bool            g_refresh_pending = false;
+static bool            g_worker_stop = false;
+static pthread_t       g_move_worker;
+static bool            g_move_worker_started = false;
+static CoreMoveRequest *g_move_head = NULL;
+static CoreMoveRequest *g_move_tail = NULL;
+
 static void core_request_redraw(void) {
     if (g_redraw_cb)
         g_redraw_cb(g_redraw_user);
@@ -50,7 +69,30 @@ int desperateOverview_core_init(CoreRedrawCallback cb, void *user_data) {
     return 0;
 }
 
+static void stop_workers(void) {
+    pthread_mutex_lock(&g_worker_lock);
+    g_worker_stop = true;
+    pthread_cond_broadcast(&g_worker_cond);
+    bool join_refresh = g_refresh_worker_started;
+    bool join_moves = g_move_worker_started;
+    g_refresh_worker_started = false;
+    g_move_worker_started = false;
+    pthread_mutex_unlock(&g_worker_lock);
+
+    /* The move worker drains its queue before exiting. */
+    if (join_moves)
+        pthread_join(g_move_worker, NULL);
+    if (join_refresh)
+        pthread_join(g_refresh_worker, NULL);
+
+    pthread_mutex_lock(&g_worker_lock);
+    g_refresh_pending = false;
+    g_worker_stop = false;
+    pthread_mutex_unlock(&g_worker_lock);
+}
+
 void desperateOverview_core_shutdown(void) {
+    stop_workers();
     desperateOverview_core_ipc_stop_events();
     desperateOverview_core_ipc_shutdown();
     desperateOverview_core_state_shutdown();
@@ -58,22 +100,115 @@ void desperateOverview_core_shutdown(void) {
     g_redraw_user = NULL;
 }
 
-void desperateOverview_core_move_window(const char *addr, int wsid) {
+static bool format_move_command(const char *addr, int wsid, char *cmd, size_t size) {
     if (!addr || !addr[0] || wsid <= 0)
-        return;
+        return false;
 
     char addr_clean[64];
     snprintf(addr_clean, sizeof(addr_clean), "%s", addr);
     desperateOverview_core_sanitize_addr(addr_clean);
 
-    char ws[16];
-    snprintf(ws, sizeof(ws), "%d", wsid);
+    snprintf(cmd, size, "dispatch movetoworkspacesilent %d,address:%s", wsid, addr_clean);
+    return true;
+}
 
+bool desperateOverview_core_move_window(const char *addr, int wsid) {
     char cmd[256];
-    snprintf(cmd, sizeof(cmd),
-             "dispatch movetoworkspacesilent %s,address:%s",
-             ws, addr_clean);
-    desperateOverview_core_ipc_send_command(cmd);
+    if (!format_move_command(addr, wsid, cmd, sizeof(cmd)))
+        return false;
+    return desperateOverview_core_ipc_send_command(cmd) == 0;
+}
+
+bool desperateOverview_core_move_windows(const char *const *addrs, int count, int wsid) {
+    if (!addrs || count <= 0 || count > MAX_WINS_PER_WS)
+        return false;
+
+    char cmds[MAX_WINS_PER_WS][256];
+    const char *list[MAX_WINS_PER_WS];
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        if (format_move_command(addrs[i], wsid, cmds[n], sizeof(cmds[n]))) {
+            list[n] = cmds[n];
+            ++n;
+        }
+    }
+    if (n == 0)
+        return false;
+    return desperateOverview_core_ipc_send_batch(list, n) == 0;
+}
+
+struct CoreMoveRequest {
+    char addrs[MAX_WINS_PER_WS][64];
+    int count;
+    int wsid;
+    CoreMoveCallback cb;
+    void *user_data;
+    CoreMoveRequest *next;
+};
+
+static void run_move_request(CoreMoveRequest *req) {
+    const char *addrs[MAX_WINS_PER_WS];
+    for (int i = 0; i < req->count; ++i)
+        addrs[i] = req->addrs[i];
+    bool ok = desperateOverview_core_move_windows(addrs, req->count, req->wsid);
+    if (req->cb)
+        req->cb(addrs, req->count, req->wsid, ok, req->user_data);
+    free(req);
+}
+
+static void *core_move_worker(void *data) {
+    (void)data;
+    desperateOverview_trace_set_thread_name("move");
+    pthread_mutex_lock(&g_worker_lock);
+    for (;;) {
+        while (!g_move_head && !g_worker_stop)
+            pthread_cond_wait(&g_worker_cond, &g_worker_lock);
+        CoreMoveRequest *req = g_move_head;
+        if (!req)
+            break;
+        g_move_head = req->next;
+        if (!g_move_head)
+            g_move_tail = NULL;
+        pthread_mutex_unlock(&g_worker_lock);
+        run_move_request(req);
+        pthread_mutex_lock(&g_worker_lock);
+    }
+    pthread_mutex_unlock(&g_worker_lock);
+    return NULL;
+}
+
+void desperateOverview_core_move_windows_async(const char *const *addrs, int count, int wsid,
+                                               CoreMoveCallback cb, void *user_data) {
+    if (!addrs || count <= 0)
+        return;
+    CoreMoveRequest *req = calloc(1, sizeof(*req));
+    if (!req)
+        return;
+    for (int i = 0; i < count && i < MAX_WINS_PER_WS; ++i)
+        snprintf(req->addrs[req->count++], sizeof(req->addrs[0]), "%s", addrs[i] ? addrs[i] : "");
+    req->wsid = wsid;
+    req->cb = cb;
+    req->user_data = user_data;
+
+    pthread_mutex_lock(&g_worker_lock);
+    if (!g_worker_stop && !g_move_worker_started) {
+        if (pthread_create(&g_move_worker, NULL, core_move_worker, NULL) == 0)
+            g_move_worker_started = true;
+    }
+    if (g_worker_stop || !g_move_worker_started) {
+        /* No worker could start, so nothing is queued, or the core is
+         * shutting down on the thread that issues moves: dispatch inline. */
+        pthread_mutex_unlock(&g_worker_lock);
+        run_move_request(req);
+        return;
+    }
+    if (g_move_tail)
+        g_move_tail->next = req;
+    else
+        g_move_head = req;
+    g_move_tail = req;
+    pthread_cond_broadcast(&g_worker_cond);
+    pthread_mutex_unlock(&g_worker_lock);
 }
 
 void desperateOverview_core_switch_workspace(const char *name, int wsid) {
@@ -109,3 +244,40 @@ void desperateOverview_core_request_full_refresh(void) {
     desperateOverview_core_state_refresh_full();
     core_request_redraw();
 }
+
+static void *core_refresh_worker(void *data) {
+    (void)data;
+    desperateOverview_trace_set_thread_name("refresh");
+    pthread_mutex_lock(&g_worker_lock);
+    for (;;) {
+        while (!g_refresh_pending && !g_worker_stop)
+            pthread_cond_wait(&g_worker_cond, &g_worker_lock);
+        if (g_worker_stop)
+            break;
+        g_refresh_pending = false;
+        pthread_mutex_unlock(&g_worker_lock);
+        desperateOverview_core_request_full_refresh();
+        pthread_mutex_lock(&g_worker_lock);
+    }
+    pthread_mutex_unlock(&g_worker_lock);
+    return NULL;
+}
+
+void desperateOverview_core_request_refresh_async(void) {
+    pthread_mutex_lock(&g_worker_lock);
+    if (g_worker_stop) {
+        pthread_mutex_unlock(&g_worker_lock);
+        return;
+    }
+    if (!g_refresh_worker_started) {
+        if (pthread_create(&g_refresh_worker, NULL, core_refresh_worker, NULL) != 0) {
+            pthread_mutex_unlock(&g_worker_lock);
+            desperateOverview_core_request_full_refresh();
+            return;
+        }
+        g_refresh_worker_started = true;
+    }
+    g_refresh_pending = true;
+    pthread_cond_broadcast(&g_worker_cond);
+    pthread_mutex_unlock(&g_worker_lock);
+}
@@ -1,15 +1,21 @@
 #define _GNU_SOURCE
 
 #include "desperateOverview_core_ipc.h"
+#include "desperateOverview_core_record.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
 
+#include <ctype.h>
 #include <errno.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <limits.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/un.h>
 
 #include <glib.h>
@@ -24,6 +30,9 @@ static bool g_event_thread_spawned = false;
 static DesperateOverviewCoreRefreshHook g_refresh_hook = NULL;
 static void *g_refresh_user = NULL;
 
+static DesperateOverviewCoreRequestOverride g_request_override = NULL;
+static void *g_request_override_user = NULL;
+
 static int init_hypr_paths(void) {
     const char *xdg = getenv("XDG_RUNTIME_DIR");
     const char *his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
@@ -56,6 +65,24 @@ static int connect_unix_socket(const char *path) {
     return fd;
 }
 
+/* Hyprland answers .socket.sock requests right away; a reply that takes
+ * longer than this means the compositor (or a test server) is stuck, and
+ * callers get an error instead of blocking forever. */
+static const int G_REPLY_TIMEOUT_MS = 5000;
+
+static int connect_command_socket(void) {
+    int fd = connect_unix_socket(g_hypr_sock_cmd);
+    if (fd < 0)
+        return -1;
+    struct timeval tv = {
+        .tv_sec = G_REPLY_TIMEOUT_MS / 1000,
+        .tv_usec = (G_REPLY_TIMEOUT_MS % 1000) * 1000,
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
 static bool event_requires_refresh(const char *event_name) {
     if (!event_name || !*event_name)
         return false;
@@ -80,6 +107,22 @@ static bool event_requires_refresh(const char *event_name) {
     return false;
 }
 
+bool desperateOverview_core_ipc_event_line_requires_refresh(const char *line) {
+    if (!line)
+        return false;
+    const char *sep = strstr(line, ">>");
+    if (!sep)
+        return false;
+
+    char name[64];
+    size_t len = (size_t)(sep - line);
+    if (len >= sizeof(name))
+        return false;
+    memcpy(name, line, len);
+    name[len] = '\0';
+    return event_requires_refresh(name);
+}
+
 static void trigger_refresh(void) {
     if (g_refresh_hook)
         g_refresh_hook(g_refresh_user);
@@ -90,6 +133,7 @@ static void *hypr_event_thread(void *data) {
     const guint BACKOFF_MIN_MS = 100;
     const guint BACKOFF_MAX_MS = 1000;
     guint backoff_ms = BACKOFF_MIN_MS;
+    desperateOverview_trace_set_thread_name("hypr-events");
 
     while (g_event_thread_running) {
         if (!g_hypr_sock_evt[0] && init_hypr_paths() < 0) {
@@ -122,13 +166,14 @@ static void *hypr_event_thread(void *data) {
             if (nl)
                 *nl = 0;
 
-            char *sep = strstr(line, ">>");
-            if (!sep)
-                continue;
-            *sep = 0;
-
-            if (event_requires_refresh(line))
+            uint64_t span = desperateOverview_trace_begin();
+            desperateOverview_core_record_event(line, strlen(line));
+            if (desperateOverview_core_ipc_event_line_requires_refresh(line)) {
+                desperateOverview_metrics_mark_set(DESPERATEOVERVIEW_MARK_EVENT,
+                                                   desperateOverview_metrics_now_ns());
                 trigger_refresh();
+            }
+            desperateOverview_trace_end("hypr_event", span, line);
         }
 
         fclose(fp);
@@ -148,42 +193,165 @@ void desperateOverview_core_ipc_shutdown(void) {
     g_hypr_sock_evt[0] = '\0';
 }
 
-int desperateOverview_core_ipc_send_command(const char *command) {
-    if (!command || !*command)
-        return -1;
+/* Dispatchers answer "ok" (one per command in a batch); anything else is
+ * the compositor's error. An empty reply counts as accepted. */
+static bool reply_is_ok(const char *reply) {
+    const char *p = reply;
+    while (*p) {
+        if (isspace((unsigned char)*p)) {
+            ++p;
+            continue;
+        }
+        if (strncmp(p, "ok", 2) != 0)
+            return false;
+        p += 2;
+    }
+    return true;
+}
+
+static int send_payload(const char *payload, size_t len) {
     if (!g_hypr_sock_cmd[0] && init_hypr_paths() < 0)
         return -1;
 
-    int fd = connect_unix_socket(g_hypr_sock_cmd);
+    int fd = connect_command_socket();
     if (fd < 0) {
         g_warning("desperateOverview: connect(%s) failed: %s",
                   g_hypr_sock_cmd, strerror(errno));
         return -1;
     }
 
-    char payload[512];
-    int len = snprintf(payload, sizeof(payload), "%s", command);
-    if (len < 0 || len >= (int)sizeof(payload)) {
-        close(fd);
-        return -1;
-    }
-
-    ssize_t w = write(fd, payload, (size_t)len);
-    if (w < 0 || (size_t)w != (size_t)len) {
+    ssize_t w = write(fd, payload, len);
+    if (w < 0 || (size_t)w != len) {
         g_warning("desperateOverview: Hyprland command write failed: %s", strerror(errno));
         close(fd);
         return -1;
     }
 
+    char reply[256];
+    size_t reply_len = 0;
     char buf[256];
-    while (read(fd, buf, sizeof(buf) - 1) > 0) {
-        /* discard response */
+    ssize_t r;
+    while ((r = read(fd, buf, sizeof(buf) - 1)) != 0) {
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            g_warning("desperateOverview: no reply to \"%s\": %s", payload, strerror(errno));
+            close(fd);
+            return -1;
+        }
+        size_t keep = sizeof(reply) - 1 - reply_len;
+        if ((size_t)r < keep)
+            keep = (size_t)r;
+        memcpy(reply + reply_len, buf, keep);
+        reply_len += keep;
     }
+    reply[reply_len] = '\0';
 
     close(fd);
+    if (!reply_is_ok(reply)) {
+        g_warning("desperateOverview: Hyprland rejected \"%s\": %s", payload, reply);
+        return -1;
+    }
     return 0;
 }
 
+int desperateOverview_core_ipc_send_command(const char *command) {
+    if (!command || !*command)
+        return -1;
+    size_t len = strlen(command);
+    if (len >= 512)
+        return -1;
+    return send_payload(command, len);
+}
+
+int desperateOverview_core_ipc_send_batch(const char *const *commands, int count) {
+    if (!commands || count <= 0)
+        return -1;
+    if (count == 1)
+        return desperateOverview_core_ipc_send_command(commands[0]);
+
+    GString *payload = g_string_new("[[BATCH]]");
+    for (int i = 0; i < count; ++i) {
+        if (!commands[i] || !*commands[i])
+            continue;
+        if (payload->len > strlen("[[BATCH]]"))
+            g_string_append_c(payload, ';');
+        g_string_append(payload, commands[i]);
+    }
+    int rc = send_payload(payload->str, payload->len);
+    g_string_free(payload, TRUE);
+    return rc;
+}
+
+char *desperateOverview_core_ipc_request(const char *request, size_t *out_len) {
+    if (out_len)
+        *out_len = 0;
+    if (!request || !*request)
+        return NULL;
+    if (g_request_override)
+        return g_request_override(request, out_len, g_request_override_user);
+    if (!g_hypr_sock_cmd[0] && init_hypr_paths() < 0)
+        return NULL;
+
+    int fd = connect_command_socket();
+    if (fd < 0)
+        return NULL;
+
+    size_t req_len = strlen(request);
+    ssize_t w = write(fd, request, req_len);
+    if (w < 0 || (size_t)w != req_len) {
+        g_warning("desperateOverview: Hyprland request write failed: %s", strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    size_t cap = 8192;
+    size_t len = 0;
+    char *buf = malloc(cap);
+    if (!buf) {
+        close(fd);
+        return NULL;
+    }
+
+    for (;;) {
+        if (cap - len - 1 == 0) {
+            cap *= 2;
+            char *tmp = realloc(buf, cap);
+            if (!tmp) {
+                free(buf);
+                close(fd);
+                return NULL;
+            }
+            buf = tmp;
+        }
+        ssize_t n = read(fd, buf + len, cap - len - 1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            g_warning("desperateOverview: no reply to \"%s\": %s", request, strerror(errno));
+            free(buf);
+            close(fd);
+            return NULL;
+        }
+        if (n == 0)
+            break;
+        len += (size_t)n;
+    }
+    close(fd);
+
+    buf[len] = 0;
+    desperateOverview_core_record_query(request, buf, len);
+    if (out_len)
+        *out_len = len;
+    return buf;
+}
+
+void desperateOverview_core_ipc_set_request_override(DesperateOverviewCoreRequestOverride fn,
+                                                     void *user_data) {
+    g_request_override = fn;
+    g_request_override_user = user_data;
+}
+
 int desperateOverview_core_ipc_start_events(DesperateOverviewCoreRefreshHook hook,
                                             void *user_data) {
     g_refresh_hook = hook;
@@ -1,6 +1,8 @@
 #define _GNU_SOURCE
 
 #include "desperateOverview_core_json.h"
+#include "desperateOverview_core_ipc.h"
+#include "desperateOverview_core_record.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -78,6 +80,7 @@ yyjson_doc *desperateOverview_read_json_from_cmd(const char *cmd) {
     char *json = run_cmd(cmd);
     if (!json)
         return NULL;
+    desperateOverview_core_record_query(cmd, json, strlen(json));
 
     yyjson_read_err err = (yyjson_read_err){0};
     yyjson_doc *doc = yyjson_read_opts(json, strlen(json), YYJSON_READ_NOFLAG, NULL, &err);
@@ -87,3 +90,21 @@ yyjson_doc *desperateOverview_read_json_from_cmd(const char *cmd) {
     return doc;
 }
 
+
+yyjson_doc *desperateOverview_read_json_from_ipc(const char *request) {
+    size_t len = 0;
+    char *json = desperateOverview_core_ipc_request(request, &len);
+    if (!json)
+        return NULL;
+    if (len == 0) {
+        free(json);
+        return NULL;
+    }
+
+    yyjson_read_err err = (yyjson_read_err){0};
+    yyjson_doc *doc = yyjson_read_opts(json, len, YYJSON_READ_NOFLAG, NULL, &err);
+    free(json);
+    if (!doc)
+        g_warning("Hyprland JSON parse failed for %s: %s (pos=%zu)", request, err.msg, err.pos);
+    return doc;
+}
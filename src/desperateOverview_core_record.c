@@ -0,0 +1,174 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_core_record.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+
+#define RECORD_MAGIC     "DOVREC01"
+#define RECORD_MAGIC_LEN 8
+#define RECORD_MAX_FIELD (256u * 1024u * 1024u)
+
+static pthread_mutex_t g_record_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *g_record_fp = NULL;
+static uint64_t g_record_start_ns = 0;
+static atomic_bool g_record_active;
+
+static uint64_t record_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void put_le(uint8_t *dst, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+        dst[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_le(const uint8_t *src, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= (uint64_t)src[i] << (8 * i);
+    return v;
+}
+
+int desperateOverview_core_record_start(const char *path) {
+    if (!path || !*path)
+        return -1;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        g_warning("desperateOverview: cannot open record file %s: %s", path, strerror(errno));
+        return -1;
+    }
+    if (fwrite(RECORD_MAGIC, 1, RECORD_MAGIC_LEN, fp) != RECORD_MAGIC_LEN) {
+        fclose(fp);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_record_lock);
+    if (g_record_fp)
+        fclose(g_record_fp);
+    g_record_fp = fp;
+    g_record_start_ns = record_now_ns();
+    atomic_store(&g_record_active, true);
+    pthread_mutex_unlock(&g_record_lock);
+    return 0;
+}
+
+void desperateOverview_core_record_stop(void) {
+    pthread_mutex_lock(&g_record_lock);
+    atomic_store(&g_record_active, false);
+    if (g_record_fp) {
+        fclose(g_record_fp);
+        g_record_fp = NULL;
+    }
+    pthread_mutex_unlock(&g_record_lock);
+}
+
+bool desperateOverview_core_record_active(void) {
+    return atomic_load_explicit(&g_record_active, memory_order_relaxed);
+}
+
+static void record_write(uint8_t type, const char *key, size_t key_len,
+                         const char *payload, size_t payload_len) {
+    if (key_len > RECORD_MAX_FIELD || payload_len > RECORD_MAX_FIELD)
+        return;
+
+    uint8_t hdr[17];
+    hdr[0] = type;
+
+    pthread_mutex_lock(&g_record_lock);
+    if (g_record_fp) {
+        put_le(hdr + 1, record_now_ns() - g_record_start_ns, 8);
+        put_le(hdr + 9, key_len, 4);
+        put_le(hdr + 13, payload_len, 4);
+        fwrite(hdr, 1, sizeof(hdr), g_record_fp);
+        if (key_len)
+            fwrite(key, 1, key_len, g_record_fp);
+        if (payload_len)
+            fwrite(payload, 1, payload_len, g_record_fp);
+    }
+    pthread_mutex_unlock(&g_record_lock);
+}
+
+void desperateOverview_core_record_event(const char *line, size_t len) {
+    if (!desperateOverview_core_record_active() || !line)
+        return;
+    record_write(DESPERATEOVERVIEW_RECORD_EVENT, line, len, NULL, 0);
+}
+
+void desperateOverview_core_record_query(const char *request, const char *reply, size_t len) {
+    if (!desperateOverview_core_record_active() || !request || !reply)
+        return;
+    record_write(DESPERATEOVERVIEW_RECORD_QUERY, request, strlen(request), reply, len);
+}
+
+FILE *desperateOverview_core_record_open(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return NULL;
+
+    char magic[RECORD_MAGIC_LEN];
+    if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) ||
+        memcmp(magic, RECORD_MAGIC, RECORD_MAGIC_LEN) != 0) {
+        fclose(fp);
+        errno = EINVAL;
+        return NULL;
+    }
+    return fp;
+}
+
+static char *read_field(FILE *fp, uint32_t len) {
+    char *buf = malloc((size_t)len + 1);
+    if (!buf)
+        return NULL;
+    if (len && fread(buf, 1, len, fp) != len) {
+        free(buf);
+        return NULL;
+    }
+    buf[len] = 0;
+    return buf;
+}
+
+int desperateOverview_core_record_read(FILE *fp, DesperateOverviewRecordEntry *out) {
+    if (!fp || !out)
+        return -1;
+    memset(out, 0, sizeof(*out));
+
+    uint8_t hdr[17];
+    size_t n = fread(hdr, 1, sizeof(hdr), fp);
+    if (n == 0)
+        return 0;
+    if (n != sizeof(hdr))
+        return -1;
+
+    out->type = hdr[0];
+    out->t_ns = get_le(hdr + 1, 8);
+    out->key_len = (uint32_t)get_le(hdr + 9, 4);
+    out->payload_len = (uint32_t)get_le(hdr + 13, 4);
+    if (out->key_len > RECORD_MAX_FIELD || out->payload_len > RECORD_MAX_FIELD)
+        return -1;
+
+    out->key = read_field(fp, out->key_len);
+    out->payload = out->key ? read_field(fp, out->payload_len) : NULL;
+    if (!out->key || !out->payload) {
+        desperateOverview_core_record_entry_clear(out);
+        return -1;
+    }
+    return 1;
+}
+
+void desperateOverview_core_record_entry_clear(DesperateOverviewRecordEntry *entry) {
+    if (!entry)
+        return;
+    free(entry->key);
+    free(entry->payload);
+    memset(entry, 0, sizeof(*entry));
+}
@@ -3,13 +3,18 @@
 #include "desperateOverview_core_state_internal.h"
 
 #include "desperateOverview_core.h"
+#include "desperateOverview_capture_backend.h"
 #include "desperateOverview_types.h"
 #include "desperateOverview_thumbnail_capture.h"
 #include "desperateOverview_core_json.h"
 #include "desperateOverview_core_utils.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -17,14 +22,27 @@
 #include "yyjson.h"
 
 typedef struct {
+    const char *request;
     const char *command;
     yyjson_doc *doc;
     bool started;
 } HyprctlFetchTask;
 
+/* Queries the Hyprland socket directly and only falls back to spawning
+ * hyprctl when the socket cannot be reached. */
+static yyjson_doc *fetch_hypr_json(const char *request, const char *command) {
+    yyjson_doc *doc = desperateOverview_read_json_from_ipc(request);
+    if (!doc)
+        doc = desperateOverview_read_json_from_cmd(command);
+    return doc;
+}
+
 static void *hyprctl_fetch_thread(void *arg) {
     HyprctlFetchTask *task = (HyprctlFetchTask *)arg;
-    task->doc = desperateOverview_read_json_from_cmd(task->command);
+    desperateOverview_trace_set_thread_name("hypr-fetch");
+    uint64_t span = desperateOverview_trace_begin();
+    task->doc = fetch_hypr_json(task->request, task->command);
+    desperateOverview_trace_end("fetch", span, task->request);
     return NULL;
 }
 
@@ -42,8 +60,14 @@ static int              g_active_count = 0;
 
 static pthread_mutex_t g_state_lock = PTHREAD_MUTEX_INITIALIZER;
 static bool g_capture_enabled = true;
+/* Set from the GTK thread on every scroll step, so it is not behind
+ * g_state_lock, which a refresh holds through fetch and capture. */
+static _Atomic uint64_t g_capture_mask = CORE_CAPTURE_ALL_WORKSPACES;
 static bool g_state_dirty = true;
 
+static CoreRefreshTimings g_last_timings;
+static uint64_t g_capture_ns = 0;
+
 static void free_window(WindowInfo *win) {
     if (!win)
         return;
@@ -57,6 +81,10 @@ static void free_window(WindowInfo *win) {
     win->title = NULL;
     win->addr[0] = '\0';
     win->x = win->y = win->w = win->h = 0;
+    win->focus_history_id = -1;
+    win->floating = false;
+    win->capture_time_ns = 0;
+    win->capture_latency_ns = 0;
 }
 
 static void clear_all_windows(void) {
@@ -79,7 +107,7 @@ static void ensure_workspace_name(int wsid) {
 }
 
 static void update_workspace_names(void) {
-    yyjson_doc *doc = desperateOverview_read_json_from_cmd("hyprctl -j workspaces 2>/dev/null");
+    yyjson_doc *doc = fetch_hypr_json("j/workspaces", "hyprctl -j workspaces 2>/dev/null");
     if (!doc)
         return;
 
@@ -136,10 +164,12 @@ static void update_monitor_geometry_from_doc(yyjson_doc *doc) {
 
     if (!found)
         g_warning("desperateOverview: focused monitor not found in hyprctl output");
+    else
+        desperateOverview_capture_set_display_transform(g_mon_transform);
 }
 
 static void update_monitor_geometry(void) {
-    yyjson_doc *doc = desperateOverview_read_json_from_cmd("hyprctl -j monitors 2>/dev/null");
+    yyjson_doc *doc = fetch_hypr_json("j/monitors", "hyprctl -j monitors 2>/dev/null");
     if (!doc)
         return;
     update_monitor_geometry_from_doc(doc);
@@ -157,14 +187,67 @@ static void update_active_workspace_from_doc(yyjson_doc *doc) {
 }
 
 static void update_active_workspace(void) {
-    yyjson_doc *doc = desperateOverview_read_json_from_cmd("hyprctl -j activeworkspace 2>/dev/null");
+    yyjson_doc *doc = fetch_hypr_json("j/activeworkspace", "hyprctl -j activeworkspace 2>/dev/null");
     if (!doc)
         return;
     update_active_workspace_from_doc(doc);
     yyjson_doc_free(doc);
 }
 
+typedef struct {
+    char    *thumb_b64;
+    uint64_t capture_time_ns;
+    uint64_t capture_latency_ns;
+} KeptThumbnail;
+
+static void kept_thumbnail_free(gpointer data) {
+    KeptThumbnail *kept = data;
+    free(kept->thumb_b64);
+    g_free(kept);
+}
+
+/* Takes the thumbnails of the current windows keyed by address, so windows
+ * on workspaces outside the capture mask keep their last image across a
+ * refresh instead of dropping to a placeholder. */
+static GHashTable *take_thumbnails(uint64_t capture_mask) {
+    if (capture_mask == CORE_CAPTURE_ALL_WORKSPACES)
+        return NULL;
+    GHashTable *kept = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, kept_thumbnail_free);
+    for (int wsid = 0; wsid < MAX_WS; ++wsid) {
+        WorkspaceWindows *W = &g_ws[wsid];
+        for (int i = 0; i < W->count; ++i) {
+            WindowInfo *win = &W->wins[i];
+            if (!win->thumb_b64 || !win->addr[0])
+                continue;
+            KeptThumbnail *entry = g_new0(KeptThumbnail, 1);
+            entry->thumb_b64 = win->thumb_b64;
+            entry->capture_time_ns = win->capture_time_ns;
+            entry->capture_latency_ns = win->capture_latency_ns;
+            win->thumb_b64 = NULL;
+            g_hash_table_replace(kept, g_strdup(win->addr), entry);
+        }
+    }
+    return kept;
+}
+
+static bool workspace_captured(uint64_t capture_mask, int wsid) {
+    return wsid >= 0 && wsid < 64 && (capture_mask & (UINT64_C(1) << wsid)) != 0;
+}
+
+static void restore_thumbnail(GHashTable *kept, WindowInfo *win) {
+    KeptThumbnail *entry = kept ? g_hash_table_lookup(kept, win->addr) : NULL;
+    if (!entry)
+        return;
+    win->thumb_b64 = entry->thumb_b64;
+    win->capture_time_ns = entry->capture_time_ns;
+    win->capture_latency_ns = entry->capture_latency_ns;
+    entry->thumb_b64 = NULL;
+}
+
 static void update_workspace_windows_from_doc(yyjson_doc *doc) {
+    /* One mask for the whole pass, so kept and captured windows agree. */
+    uint64_t capture_mask = atomic_load_explicit(&g_capture_mask, memory_order_relaxed);
+    GHashTable *kept = take_thumbnails(capture_mask);
     clear_all_windows();
 
     int used_ws[MAX_WS] = {0};
@@ -174,6 +257,8 @@ static void update_workspace_windows_from_doc(yyjson_doc *doc) {
 
     yyjson_val *root = yyjson_doc_get_root(doc);
     if (!yyjson_is_arr(root)) {
+        if (kept)
+            g_hash_table_destroy(kept);
         return;
     }
 
@@ -228,17 +313,27 @@ static void update_workspace_windows_from_doc(yyjson_doc *doc) {
         win->class_name = desperateOverview_json_dup_str(yyjson_obj_get(entry, "class"));
         win->initial_class = desperateOverview_json_dup_str(yyjson_obj_get(entry, "initialClass"));
         win->title = desperateOverview_json_dup_str(yyjson_obj_get(entry, "title"));
+        win->focus_history_id = desperateOverview_json_get_int(yyjson_obj_get(entry, "focusHistoryID"), -1);
+        win->floating = desperateOverview_json_is_true(yyjson_obj_get(entry, "floating"));
         win->thumb_b64 = NULL;
 
-        if (capture_count < (int)(MAX_WS * MAX_WINS_PER_WS))
+        if (!workspace_captured(capture_mask, wsid))
+            restore_thumbnail(kept, win);
+        else if (capture_count < (int)(MAX_WS * MAX_WINS_PER_WS))
             capture_targets[capture_count++] = win;
 
         W->count++;
         used_ws[wsid] = 1;
     }
 
-    if (g_capture_enabled && capture_count > 0)
+    if (kept)
+        g_hash_table_destroy(kept);
+
+    if (g_capture_enabled && capture_count > 0) {
+        uint64_t capture_start = desperateOverview_metrics_now_ns();
         capture_thumbnails_parallel(capture_targets, capture_count);
+        g_capture_ns += desperateOverview_metrics_now_ns() - capture_start;
+    }
 
     if (g_active_ws > 0 && g_active_ws < MAX_WS)
         used_ws[g_active_ws] = 1;
@@ -283,7 +378,7 @@ static void update_workspace_windows_from_doc(yyjson_doc *doc) {
 }
 
 static void update_workspace_windows(void) {
-    yyjson_doc *doc = desperateOverview_read_json_from_cmd("hyprctl -j clients 2>/dev/null");
+    yyjson_doc *doc = fetch_hypr_json("j/clients", "hyprctl -j clients 2>/dev/null");
     if (!doc)
         return;
     update_workspace_windows_from_doc(doc);
@@ -291,10 +386,13 @@ static void update_workspace_windows(void) {
 }
 
 void desperateOverview_core_state_refresh_full(void) {
+    uint64_t span = desperateOverview_trace_begin();
     pthread_mutex_lock(&g_state_lock);
-    HyprctlFetchTask monitor_task = { .command = "hyprctl -j monitors 2>/dev/null", .doc = NULL, .started = false };
-    HyprctlFetchTask workspace_task = { .command = "hyprctl -j activeworkspace 2>/dev/null", .doc = NULL, .started = false };
-    HyprctlFetchTask clients_task = { .command = "hyprctl -j clients 2>/dev/null", .doc = NULL, .started = false };
+    uint64_t refresh_start = desperateOverview_metrics_now_ns();
+    g_capture_ns = 0;
+    HyprctlFetchTask monitor_task = { .request = "j/monitors", .command = "hyprctl -j monitors 2>/dev/null", .doc = NULL, .started = false };
+    HyprctlFetchTask workspace_task = { .request = "j/activeworkspace", .command = "hyprctl -j activeworkspace 2>/dev/null", .doc = NULL, .started = false };
+    HyprctlFetchTask clients_task = { .request = "j/clients", .command = "hyprctl -j clients 2>/dev/null", .doc = NULL, .started = false };
 
     pthread_t monitor_thread, workspace_thread, clients_thread;
 
@@ -311,6 +409,7 @@ void desperateOverview_core_state_refresh_full(void) {
         pthread_join(monitor_thread, NULL);
     if (clients_task.started)
         pthread_join(clients_thread, NULL);
+    uint64_t fetch_done = desperateOverview_metrics_now_ns();
 
     if (workspace_task.doc)
         update_active_workspace_from_doc(workspace_task.doc);
@@ -335,6 +434,29 @@ void desperateOverview_core_state_refresh_full(void) {
         yyjson_doc_free(clients_task.doc);
 
     g_state_dirty = !g_capture_enabled;
+
+    /* "parse" covers everything after the parallel fetch except capture,
+     * including the sequential hyprctl fallbacks. */
+    uint64_t refresh_end = desperateOverview_metrics_now_ns();
+    g_last_timings.fetch_ns = fetch_done - refresh_start;
+    g_last_timings.capture_ns = g_capture_ns;
+    g_last_timings.total_ns = refresh_end - refresh_start;
+    g_last_timings.parse_ns = g_last_timings.total_ns - g_last_timings.fetch_ns - g_capture_ns;
+    desperateOverview_metrics_record(DESPERATEOVERVIEW_METRIC_REFRESH_FETCH, g_last_timings.fetch_ns);
+    desperateOverview_metrics_record(DESPERATEOVERVIEW_METRIC_REFRESH_PARSE, g_last_timings.parse_ns);
+    if (g_capture_ns > 0)
+        desperateOverview_metrics_record(DESPERATEOVERVIEW_METRIC_REFRESH_CAPTURE, g_capture_ns);
+    desperateOverview_metrics_record(DESPERATEOVERVIEW_METRIC_REFRESH_TOTAL, g_last_timings.total_ns);
+    desperateOverview_metrics_gauge_set(DESPERATEOVERVIEW_GAUGE_LAST_REFRESH_NS, (int64_t)refresh_end);
+    pthread_mutex_unlock(&g_state_lock);
+    desperateOverview_trace_end("refresh_full", span, NULL);
+}
+
+void desperateOverview_core_get_refresh_timings(CoreRefreshTimings *out) {
+    if (!out)
+        return;
+    pthread_mutex_lock(&g_state_lock);
+    *out = g_last_timings;
     pthread_mutex_unlock(&g_state_lock);
 }
 
@@ -361,6 +483,10 @@ static void copy_window_to_core(const WindowInfo *src, CoreWindow *dst) {
     dst->class_name = src->class_name ? strdup(src->class_name) : NULL;
     dst->initial_class = src->initial_class ? strdup(src->initial_class) : NULL;
     dst->title = src->title ? strdup(src->title) : NULL;
+    dst->focus_history_id = src->focus_history_id;
+    dst->floating = src->floating;
+    dst->capture_time_ns = src->capture_time_ns;
+    dst->capture_latency_ns = src->capture_latency_ns;
 }
 
 void desperateOverview_core_copy_state(CoreState *out_state) {
@@ -421,6 +547,10 @@ void desperateOverview_core_set_thumbnail_capture_enabled(bool enabled) {
     pthread_mutex_unlock(&g_state_lock);
 }
 
+void desperateOverview_core_set_capture_workspaces(uint64_t mask) {
+    atomic_store_explicit(&g_capture_mask, mask, memory_order_relaxed);
+}
+
 bool desperateOverview_core_state_needs_refresh(void) {
     pthread_mutex_lock(&g_state_lock);
     bool dirty = g_state_dirty;
@@ -0,0 +1,292 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_metrics.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define METRIC_MIN_SHIFT   10   /* bucket 0 holds everything below ~1us */
+#define METRIC_MAX_SHIFT   35   /* last regular octave tops out at ~34s */
+#define METRIC_SUB_BITS    2
+#define METRIC_SUB_COUNT   (1 << METRIC_SUB_BITS)
+#define METRIC_BUCKETS     (2 + (METRIC_MAX_SHIFT - METRIC_MIN_SHIFT + 1) * METRIC_SUB_COUNT)
+
+typedef struct {
+    _Atomic uint64_t buckets[METRIC_BUCKETS];
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t last_ns;
+} MetricHistogram;
+
+static MetricHistogram g_histograms[DESPERATEOVERVIEW_METRIC_COUNT];
+static _Atomic uint64_t g_marks[DESPERATEOVERVIEW_MARK_COUNT];
+static _Atomic uint64_t g_counters[DESPERATEOVERVIEW_COUNTER_COUNT];
+static _Atomic int64_t  g_gauges[DESPERATEOVERVIEW_GAUGE_COUNT];
+
+static const char *const g_metric_names[DESPERATEOVERVIEW_METRIC_COUNT] = {
+    [DESPERATEOVERVIEW_METRIC_REFRESH_FETCH]   = "refresh_fetch",
+    [DESPERATEOVERVIEW_METRIC_REFRESH_PARSE]   = "refresh_parse",
+    [DESPERATEOVERVIEW_METRIC_REFRESH_CAPTURE] = "refresh_capture",
+    [DESPERATEOVERVIEW_METRIC_REFRESH_TOTAL]   = "refresh_total",
+    [DESPERATEOVERVIEW_METRIC_CAPTURE_GRAB]    = "capture_grab",
+    [DESPERATEOVERVIEW_METRIC_CAPTURE_ENCODE]  = "capture_encode",
+    [DESPERATEOVERVIEW_METRIC_UI_COPY]         = "ui_copy",
+    [DESPERATEOVERVIEW_METRIC_THUMB_DECODE]    = "thumb_decode",
+    [DESPERATEOVERVIEW_METRIC_LIVE_DECODE]     = "live_decode",
+    [DESPERATEOVERVIEW_METRIC_PREVIEW_SCALE]   = "preview_scale",
+    [DESPERATEOVERVIEW_METRIC_OVERLAY_BUILD]   = "overlay_build",
+    [DESPERATEOVERVIEW_METRIC_DRAW_CELL]       = "draw_cell",
+    [DESPERATEOVERVIEW_METRIC_DRAW_CURRENT]    = "draw_current",
+    [DESPERATEOVERVIEW_METRIC_EVENT_TO_UI]     = "event_to_ui",
+    [DESPERATEOVERVIEW_METRIC_EVENT_TO_FRAME]  = "event_to_frame",
+    [DESPERATEOVERVIEW_METRIC_SHOW_TO_FRAME]   = "show_to_frame",
+    [DESPERATEOVERVIEW_METRIC_ANIM_FRAME_INTERVAL] = "anim_frame_interval",
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+} g_counter_info[DESPERATEOVERVIEW_COUNTER_COUNT] = {
+    [DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_HIT]  = { "desperateoverview_thumb_cache_hits_total",
+                                                     "Thumbnails reused from the decode cache." },
+    [DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_MISS] = { "desperateoverview_thumb_cache_misses_total",
+                                                     "Thumbnails that had to be decoded." },
+    [DESPERATEOVERVIEW_COUNTER_CAPTURE_FAILED]   = { "desperateoverview_capture_failures_total",
+                                                     "Window captures the backend could not grab." },
+    [DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_HIT]  = { "desperateoverview_surface_cache_hits_total",
+                                                       "Previews painted from a cached scaled surface." },
+    [DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_MISS] = { "desperateoverview_surface_cache_misses_total",
+                                                       "Previews that had to be rescaled." },
+};
+
+uint64_t desperateOverview_metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int bucket_index(uint64_t ns) {
+    if (ns < (1ull << METRIC_MIN_SHIFT))
+        return 0;
+    int shift = 63 - __builtin_clzll(ns);
+    if (shift > METRIC_MAX_SHIFT)
+        return METRIC_BUCKETS - 1;
+    int sub = (int)((ns >> (shift - METRIC_SUB_BITS)) & (METRIC_SUB_COUNT - 1));
+    return 1 + (shift - METRIC_MIN_SHIFT) * METRIC_SUB_COUNT + sub;
+}
+
+/* Exclusive upper bound of a bucket; the overflow bucket is unbounded. */
+static uint64_t bucket_upper(int idx) {
+    if (idx <= 0)
+        return 1ull << METRIC_MIN_SHIFT;
+    if (idx >= METRIC_BUCKETS - 1)
+        return UINT64_MAX;
+    int shift = METRIC_MIN_SHIFT + (idx - 1) / METRIC_SUB_COUNT;
+    uint64_t sub = (uint64_t)((idx - 1) % METRIC_SUB_COUNT);
+    return (METRIC_SUB_COUNT + sub + 1) << (shift - METRIC_SUB_BITS);
+}
+
+void desperateOverview_metrics_record(DesperateOverviewMetric metric, uint64_t ns) {
+    if ((unsigned)metric >= DESPERATEOVERVIEW_METRIC_COUNT)
+        return;
+    MetricHistogram *h = &g_histograms[metric];
+    atomic_fetch_add_explicit(&h->buckets[bucket_index(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, ns, memory_order_relaxed);
+    atomic_store_explicit(&h->last_ns, ns, memory_order_relaxed);
+
+    uint64_t prev = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (ns > prev &&
+           !atomic_compare_exchange_weak_explicit(&h->max_ns, &prev, ns,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void desperateOverview_metrics_record_since(DesperateOverviewMetric metric, uint64_t start_ns) {
+    uint64_t now = desperateOverview_metrics_now_ns();
+    desperateOverview_metrics_record(metric, now > start_ns ? now - start_ns : 0);
+}
+
+void desperateOverview_metrics_mark_set(DesperateOverviewMark mark, uint64_t ns) {
+    if ((unsigned)mark >= DESPERATEOVERVIEW_MARK_COUNT || ns == 0)
+        return;
+    uint64_t expected = 0;
+    atomic_compare_exchange_strong_explicit(&g_marks[mark], &expected, ns,
+                                            memory_order_relaxed,
+                                            memory_order_relaxed);
+}
+
+uint64_t desperateOverview_metrics_mark_take(DesperateOverviewMark mark) {
+    if ((unsigned)mark >= DESPERATEOVERVIEW_MARK_COUNT)
+        return 0;
+    return atomic_exchange_explicit(&g_marks[mark], 0, memory_order_relaxed);
+}
+
+void desperateOverview_metrics_count(DesperateOverviewCounter counter) {
+    if ((unsigned)counter < DESPERATEOVERVIEW_COUNTER_COUNT)
+        atomic_fetch_add_explicit(&g_counters[counter], 1, memory_order_relaxed);
+}
+
+uint64_t desperateOverview_metrics_counter(DesperateOverviewCounter counter) {
+    if ((unsigned)counter >= DESPERATEOVERVIEW_COUNTER_COUNT)
+        return 0;
+    return atomic_load_explicit(&g_counters[counter], memory_order_relaxed);
+}
+
+void desperateOverview_metrics_gauge_add(DesperateOverviewGauge gauge, int64_t delta) {
+    if ((unsigned)gauge < DESPERATEOVERVIEW_GAUGE_COUNT)
+        atomic_fetch_add_explicit(&g_gauges[gauge], delta, memory_order_relaxed);
+}
+
+void desperateOverview_metrics_gauge_set(DesperateOverviewGauge gauge, int64_t value) {
+    if ((unsigned)gauge < DESPERATEOVERVIEW_GAUGE_COUNT)
+        atomic_store_explicit(&g_gauges[gauge], value, memory_order_relaxed);
+}
+
+int64_t desperateOverview_metrics_gauge(DesperateOverviewGauge gauge) {
+    if ((unsigned)gauge >= DESPERATEOVERVIEW_GAUGE_COUNT)
+        return 0;
+    return atomic_load_explicit(&g_gauges[gauge], memory_order_relaxed);
+}
+
+const char *desperateOverview_metrics_name(DesperateOverviewMetric metric) {
+    if ((unsigned)metric >= DESPERATEOVERVIEW_METRIC_COUNT)
+        return "unknown";
+    return g_metric_names[metric];
+}
+
+static uint64_t quantile_from_buckets(const uint64_t *counts, uint64_t total,
+                                      uint64_t max_ns, double q) {
+    if (total == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(q * (double)total + 0.999999);
+    if (rank == 0)
+        rank = 1;
+    /* Interpolate linearly inside the bucket that holds the rank. */
+    uint64_t seen = 0;
+    for (int i = 0; i < METRIC_BUCKETS; ++i) {
+        if (counts[i] == 0 || seen + counts[i] < rank) {
+            seen += counts[i];
+            continue;
+        }
+        if (i == METRIC_BUCKETS - 1)
+            return max_ns;
+        uint64_t lower = i > 0 ? bucket_upper(i - 1) : 0;
+        uint64_t upper = bucket_upper(i);
+        double frac = (double)(rank - seen) / (double)counts[i];
+        uint64_t value = lower + (uint64_t)((double)(upper - lower) * frac);
+        return value < max_ns ? value : max_ns;
+    }
+    return max_ns;
+}
+
+void desperateOverview_metrics_get(DesperateOverviewMetric metric,
+                                   DesperateOverviewMetricSummary *out) {
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if ((unsigned)metric >= DESPERATEOVERVIEW_METRIC_COUNT)
+        return;
+
+    MetricHistogram *h = &g_histograms[metric];
+    uint64_t counts[METRIC_BUCKETS];
+    uint64_t total = 0;
+    for (int i = 0; i < METRIC_BUCKETS; ++i) {
+        counts[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+
+    out->count = total;
+    out->sum_ns = atomic_load_explicit(&h->sum_ns, memory_order_relaxed);
+    out->max_ns = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    out->last_ns = atomic_load_explicit(&h->last_ns, memory_order_relaxed);
+    out->p50_ns = quantile_from_buckets(counts, total, out->max_ns, 0.50);
+    out->p90_ns = quantile_from_buckets(counts, total, out->max_ns, 0.90);
+    out->p99_ns = quantile_from_buckets(counts, total, out->max_ns, 0.99);
+}
+
+void desperateOverview_metrics_reset(void) {
+    for (int m = 0; m < DESPERATEOVERVIEW_METRIC_COUNT; ++m) {
+        MetricHistogram *h = &g_histograms[m];
+        for (int i = 0; i < METRIC_BUCKETS; ++i)
+            atomic_store_explicit(&h->buckets[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&h->sum_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->max_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->last_ns, 0, memory_order_relaxed);
+    }
+    for (int c = 0; c < DESPERATEOVERVIEW_COUNTER_COUNT; ++c)
+        atomic_store_explicit(&g_counters[c], 0, memory_order_relaxed);
+    for (int k = 0; k < DESPERATEOVERVIEW_MARK_COUNT; ++k)
+        atomic_store_explicit(&g_marks[k], 0, memory_order_relaxed);
+}
+
+char *desperateOverview_metrics_format_prometheus(size_t *out_len) {
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *fp = open_memstream(&buf, &len);
+    if (!fp)
+        return NULL;
+
+    DesperateOverviewMetricSummary s[DESPERATEOVERVIEW_METRIC_COUNT];
+    for (int m = 0; m < DESPERATEOVERVIEW_METRIC_COUNT; ++m)
+        desperateOverview_metrics_get((DesperateOverviewMetric)m, &s[m]);
+
+    fputs("# HELP desperateoverview_stage_seconds Latency of each overlay pipeline stage.\n"
+          "# TYPE desperateoverview_stage_seconds summary\n", fp);
+    static const struct { const char *label; size_t offset; } quantiles[] = {
+        { "0.5",  offsetof(DesperateOverviewMetricSummary, p50_ns) },
+        { "0.9",  offsetof(DesperateOverviewMetricSummary, p90_ns) },
+        { "0.99", offsetof(DesperateOverviewMetricSummary, p99_ns) },
+    };
+    for (int m = 0; m < DESPERATEOVERVIEW_METRIC_COUNT; ++m) {
+        const char *name = g_metric_names[m];
+        for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); ++q) {
+            uint64_t ns = *(const uint64_t *)((const char *)&s[m] + quantiles[q].offset);
+            fprintf(fp, "desperateoverview_stage_seconds{stage=\"%s\",quantile=\"%s\"} %.9f\n",
+                    name, quantiles[q].label, (double)ns / 1e9);
+        }
+        fprintf(fp, "desperateoverview_stage_seconds_sum{stage=\"%s\"} %.9f\n",
+                name, (double)s[m].sum_ns / 1e9);
+        fprintf(fp, "desperateoverview_stage_seconds_count{stage=\"%s\"} %llu\n",
+                name, (unsigned long long)s[m].count);
+    }
+
+    fputs("# HELP desperateoverview_stage_max_seconds Slowest observation of each stage.\n"
+          "# TYPE desperateoverview_stage_max_seconds gauge\n", fp);
+    for (int m = 0; m < DESPERATEOVERVIEW_METRIC_COUNT; ++m)
+        fprintf(fp, "desperateoverview_stage_max_seconds{stage=\"%s\"} %.9f\n",
+                g_metric_names[m], (double)s[m].max_ns / 1e9);
+
+    for (int c = 0; c < DESPERATEOVERVIEW_COUNTER_COUNT; ++c) {
+        fprintf(fp, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+                g_counter_info[c].name, g_counter_info[c].help,
+                g_counter_info[c].name, g_counter_info[c].name,
+                (unsigned long long)desperateOverview_metrics_counter((DesperateOverviewCounter)c));
+    }
+
+    fprintf(fp, "# HELP desperateoverview_captures_in_flight Window captures currently running.\n"
+                "# TYPE desperateoverview_captures_in_flight gauge\n"
+                "desperateoverview_captures_in_flight %lld\n",
+            (long long)desperateOverview_metrics_gauge(DESPERATEOVERVIEW_GAUGE_CAPTURES_IN_FLIGHT));
+
+    int64_t last_refresh = desperateOverview_metrics_gauge(DESPERATEOVERVIEW_GAUGE_LAST_REFRESH_NS);
+    if (last_refresh > 0) {
+        uint64_t now = desperateOverview_metrics_now_ns();
+        double age = now > (uint64_t)last_refresh ? (double)(now - (uint64_t)last_refresh) / 1e9 : 0.0;
+        fprintf(fp, "# HELP desperateoverview_seconds_since_refresh Age of the core state.\n"
+                    "# TYPE desperateoverview_seconds_since_refresh gauge\n"
+                    "desperateoverview_seconds_since_refresh %.3f\n", age);
+    }
+
+    if (fclose(fp) != 0) {
+        free(buf);
+        return NULL;
+    }
+    if (out_len)
+        *out_len = len;
+    return buf;
+}
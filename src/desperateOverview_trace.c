@@ -0,0 +1,288 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_trace.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#define TRACE_CHUNK_EVENTS  4096
+#define TRACE_MAX_EVENTS    (1u << 20)  /* ~80 MB worst case, then spans are dropped */
+#define TRACE_DETAIL_LEN    48
+#define TRACE_MAX_THREADS   256
+
+typedef struct {
+    const char *name;
+    uint64_t    start_ns;
+    uint64_t    dur_ns;
+    pid_t       tid;
+    char        detail[TRACE_DETAIL_LEN];
+} TraceEvent;
+
+/* A chunk is written by one thread only; `count` is published with release
+ * semantics so the writer of the JSON file never reads a half-filled slot. */
+typedef struct TraceChunk {
+    struct TraceChunk *_Atomic next;
+    _Atomic uint32_t count;
+    TraceEvent events[TRACE_CHUNK_EVENTS];
+} TraceChunk;
+
+/* Buffers outlive their threads: capture workers are spawned per refresh,
+ * so an exiting thread hands its buffer back for the next one to reuse. */
+typedef struct TraceBuffer {
+    struct TraceBuffer *next_all;
+    TraceChunk *head;
+    TraceChunk *tail;
+    bool in_use;
+} TraceBuffer;
+
+typedef struct {
+    pid_t tid;
+    char  name[32];
+} TraceThreadName;
+
+atomic_bool desperateOverview_trace_enabled = false;
+
+static pthread_mutex_t g_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceBuffer    *g_trace_buffers = NULL;
+static pthread_key_t   g_trace_key;
+static bool            g_trace_key_ready = false;
+static bool            g_trace_used = false;
+static char           *g_trace_path = NULL;
+static uint64_t        g_trace_origin_ns = 0;
+static _Atomic uint32_t g_trace_event_count = 0;
+static _Atomic uint32_t g_trace_dropped = 0;
+static TraceThreadName g_trace_threads[TRACE_MAX_THREADS];
+static int             g_trace_thread_count = 0;
+
+static __thread TraceBuffer *t_buffer = NULL;
+static __thread pid_t        t_tid = 0;
+
+uint64_t desperateOverview_trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static pid_t trace_tid(void) {
+    if (!t_tid)
+        t_tid = (pid_t)syscall(SYS_gettid);
+    return t_tid;
+}
+
+static void trace_release_buffer(void *data) {
+    TraceBuffer *buf = data;
+    pthread_mutex_lock(&g_trace_lock);
+    buf->in_use = false;
+    pthread_mutex_unlock(&g_trace_lock);
+}
+
+static TraceChunk *trace_chunk_new(void) {
+    TraceChunk *chunk = malloc(sizeof(*chunk));
+    if (!chunk)
+        return NULL;
+    atomic_init(&chunk->next, NULL);
+    atomic_init(&chunk->count, 0);
+    return chunk;
+}
+
+static TraceBuffer *trace_acquire_buffer(void) {
+    if (t_buffer)
+        return t_buffer;
+
+    pthread_mutex_lock(&g_trace_lock);
+    TraceBuffer *buf = g_trace_buffers;
+    while (buf && buf->in_use)
+        buf = buf->next_all;
+    if (!buf) {
+        buf = calloc(1, sizeof(*buf));
+        TraceChunk *chunk = buf ? trace_chunk_new() : NULL;
+        if (!chunk) {
+            free(buf);
+            pthread_mutex_unlock(&g_trace_lock);
+            return NULL;
+        }
+        buf->head = buf->tail = chunk;
+        buf->next_all = g_trace_buffers;
+        g_trace_buffers = buf;
+    }
+    buf->in_use = true;
+    pthread_mutex_unlock(&g_trace_lock);
+
+    if (g_trace_key_ready)
+        pthread_setspecific(g_trace_key, buf);
+    t_buffer = buf;
+    return buf;
+}
+
+/* g_strlcpy, but a multi-byte character cut by the limit is dropped whole
+ * so window titles never leave half a UTF-8 sequence in the JSON. */
+static void trace_copy_utf8(char *dst, const char *src, size_t size) {
+    size_t len = g_strlcpy(dst, src, size);
+    if (len < size)
+        return;
+    size_t end = size - 1;
+    size_t lead = end;
+    while (lead > 0 && ((guchar)dst[lead - 1] & 0xC0) == 0x80)
+        lead--;
+    if (lead == 0)
+        return;
+    guchar c = (guchar)dst[lead - 1];
+    if (c >= 0xC0 && lead - 1 + (size_t)g_utf8_skip[c] > end)
+        dst[lead - 1] = '\0';
+}
+
+void desperateOverview_trace_emit(const char *name, uint64_t start_ns, const char *detail) {
+    uint64_t end_ns = desperateOverview_trace_now_ns();
+    if (!atomic_load_explicit(&desperateOverview_trace_enabled, memory_order_relaxed))
+        return;
+    if (atomic_fetch_add_explicit(&g_trace_event_count, 1, memory_order_relaxed) >= TRACE_MAX_EVENTS) {
+        atomic_fetch_add_explicit(&g_trace_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    TraceBuffer *buf = trace_acquire_buffer();
+    if (!buf)
+        return;
+
+    TraceChunk *chunk = buf->tail;
+    uint32_t idx = atomic_load_explicit(&chunk->count, memory_order_relaxed);
+    if (idx >= TRACE_CHUNK_EVENTS) {
+        TraceChunk *fresh = trace_chunk_new();
+        if (!fresh) {
+            atomic_fetch_add_explicit(&g_trace_dropped, 1, memory_order_relaxed);
+            return;
+        }
+        atomic_store_explicit(&chunk->next, fresh, memory_order_release);
+        buf->tail = chunk = fresh;
+        idx = 0;
+    }
+
+    TraceEvent *ev = &chunk->events[idx];
+    ev->name = name;
+    ev->start_ns = start_ns;
+    ev->dur_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+    ev->tid = trace_tid();
+    if (detail)
+        trace_copy_utf8(ev->detail, detail, sizeof(ev->detail));
+    else
+        ev->detail[0] = '\0';
+    atomic_store_explicit(&chunk->count, idx + 1, memory_order_release);
+}
+
+void desperateOverview_trace_set_thread_name(const char *name) {
+    if (!name || !atomic_load_explicit(&desperateOverview_trace_enabled, memory_order_relaxed))
+        return;
+    pid_t tid = trace_tid();
+    pthread_mutex_lock(&g_trace_lock);
+    int slot = -1;
+    for (int i = 0; i < g_trace_thread_count; ++i) {
+        if (g_trace_threads[i].tid == tid) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0 && g_trace_thread_count < TRACE_MAX_THREADS)
+        slot = g_trace_thread_count++;
+    if (slot >= 0) {
+        g_trace_threads[slot].tid = tid;
+        trace_copy_utf8(g_trace_threads[slot].name, name, sizeof(g_trace_threads[slot].name));
+    }
+    pthread_mutex_unlock(&g_trace_lock);
+}
+
+int desperateOverview_trace_start(const char *path) {
+    if (!path || !*path)
+        return -1;
+
+    pthread_mutex_lock(&g_trace_lock);
+    if (g_trace_used) {
+        pthread_mutex_unlock(&g_trace_lock);
+        g_warning("desperateOverview trace: only one trace per process is supported");
+        return -1;
+    }
+    g_trace_used = true;
+    if (!g_trace_key_ready && pthread_key_create(&g_trace_key, trace_release_buffer) == 0)
+        g_trace_key_ready = true;
+    g_trace_path = g_strdup(path);
+    g_trace_origin_ns = desperateOverview_trace_now_ns();
+    pthread_mutex_unlock(&g_trace_lock);
+
+    atomic_store_explicit(&desperateOverview_trace_enabled, true, memory_order_release);
+    return 0;
+}
+
+static void write_json_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(fp, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(fp, "\\u%04x", c);
+        else
+            fputc(c, fp);
+    }
+    fputc('"', fp);
+}
+
+void desperateOverview_trace_stop(void) {
+    if (!atomic_exchange_explicit(&desperateOverview_trace_enabled, false, memory_order_acq_rel))
+        return;
+
+    pthread_mutex_lock(&g_trace_lock);
+    FILE *fp = fopen(g_trace_path, "w");
+    if (!fp) {
+        g_warning("desperateOverview trace: cannot write '%s'", g_trace_path);
+        pthread_mutex_unlock(&g_trace_lock);
+        return;
+    }
+
+    const pid_t pid = getpid();
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", fp);
+
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"name\":\"desperateOverview\"}}", pid, pid);
+    for (int i = 0; i < g_trace_thread_count; ++i) {
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                pid, g_trace_threads[i].tid);
+        write_json_string(fp, g_trace_threads[i].name);
+        fputs("}}", fp);
+    }
+
+    /* Threads that are still running may append after the flag drops; only
+     * slots published before the acquire load below are read. */
+    for (TraceBuffer *buf = g_trace_buffers; buf; buf = buf->next_all) {
+        for (TraceChunk *chunk = buf->head; chunk;
+             chunk = atomic_load_explicit(&chunk->next, memory_order_acquire)) {
+            uint32_t n = atomic_load_explicit(&chunk->count, memory_order_acquire);
+            for (uint32_t i = 0; i < n; ++i) {
+                const TraceEvent *ev = &chunk->events[i];
+                uint64_t rel = ev->start_ns > g_trace_origin_ns ? ev->start_ns - g_trace_origin_ns : 0;
+                fputs(",\n{\"name\":", fp);
+                write_json_string(fp, ev->name);
+                fprintf(fp, ",\"cat\":\"desperateOverview\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                            "\"pid\":%d,\"tid\":%d",
+                        (double)rel / 1000.0, (double)ev->dur_ns / 1000.0, pid, ev->tid);
+                if (ev->detail[0]) {
+                    fputs(",\"args\":{\"detail\":", fp);
+                    write_json_string(fp, ev->detail);
+                    fputc('}', fp);
+                }
+                fputc('}', fp);
+            }
+        }
+    }
+
+    fprintf(fp, "\n],\"otherData\":{\"dropped_spans\":%u}}\n",
+            atomic_load_explicit(&g_trace_dropped, memory_order_relaxed));
+    if (fclose(fp) != 0)
+        g_warning("desperateOverview trace: failed to finish '%s'", g_trace_path);
+    pthread_mutex_unlock(&g_trace_lock);
+}
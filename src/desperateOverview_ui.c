@@ -16,14 +16,23 @@
 #include "desperateOverview_core.h"
 #include "desperateOverview_config.h"
 #include "desperateOverview_geometry.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
 #include "desperateOverview_types.h"
+#include "desperateOverview_ui_anim.h"
 #include "desperateOverview_ui_drag.h"
+#include "desperateOverview_ui_drag_layer.h"
 #include "desperateOverview_ui_drawing.h"
 #include "desperateOverview_ui_live.h"
+#include "desperateOverview_ui_moves.h"
+#include "desperateOverview_ui_preview_layout.h"
 #include "desperateOverview_ui_css.h"
 #include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_strip.h"
+#include "desperateOverview_ui_surface_cache.h"
 #include "desperateOverview_ui_thumb_cache.h"
 #include "desperateOverview_ui_events.h"
+#include "desperateOverview_ui_hud.h"
 #include "desperateOverview_ui_render.h"
 #include "desperateOverview_ui.h"
 
@@ -36,16 +45,20 @@ static gboolean on_overlay_window_button_press(GtkWidget *widget, GdkEventButton
 static gboolean point_inside_widget(GtkWidget *target, GtkWidget *relative_to, double px, double py);
 static GtkWidget *build_overlay_window(void);
 void close_overlay(void);
+void dismiss_overlay(void);
 static void on_overlay_destroy(GtkWidget *widget, gpointer data);
 static gboolean show_overlay_idle(gpointer data);
 static gboolean hide_overlay_idle(gpointer data);
 static gboolean gtk_quit_idle(gpointer data);
-static GdkMonitor *match_monitor_for_window(GtkWidget *window);
 static void configure_layer_shell(GtkWindow *window);
 static void prune_empty_workspaces(void);
 static void handle_live_preview_ready(WindowInfo *win, GdkPixbuf *pixbuf, gpointer user_data);
+static void start_workspace_slide(int old_idx, int new_idx);
+static void start_fade(GtkWidget *window, double to, DesperateOverviewAnimDone done);
+static void fade_in_done(gboolean finished, gpointer data);
 
 static gboolean g_exit_on_hide = FALSE;
+static gboolean g_overlay_closing = FALSE;   /* fading out before close_overlay() */
 
 static void clear_window_resources(WindowInfo *win) {
     if (!win)
@@ -78,6 +91,8 @@ static void clear_window_resources(WindowInfo *win) {
     win->top_preview_valid = FALSE;
     win->bottom_preview_valid = FALSE;
     win->thumb_crc = 0;
+    win->capture_time_ns = 0;
+    win->capture_latency_ns = 0;
 }
 
 static void reset_interaction_state(void) {
@@ -95,12 +110,25 @@ static void reset_interaction_state(void) {
 void desperateOverview_ui_refresh_active_workspace_view(int wsid) {
     if (wsid <= 0 || wsid >= MAX_WS)
         return;
-    if (g_active_workspace != wsid)
+    int old_wsid = g_active_workspace;
+    if (g_active_workspace != wsid) {
+        int old_idx = desperateOverview_ui_find_active_index(g_active_workspace);
         g_active_workspace = wsid;
-    if (g_overlay_visible)
+        if (g_overlay_visible)
+            start_workspace_slide(old_idx, desperateOverview_ui_find_active_index(wsid));
+    }
+    if (g_overlay_visible) {
+        desperateOverview_ui_strip_scroll_to(wsid);
         desperateOverview_ui_build_live_previews(g_active_workspace, g_ws);
+    }
     desperateOverview_ui_set_hover_window(NULL, FALSE);
-    desperateOverview_ui_queue_cells_redraw();
+    /* Only the active border moved between two cells; the preview shows
+     * the new workspace. */
+    if (old_wsid != wsid)
+        desperateOverview_ui_strip_queue_cell(old_wsid);
+    desperateOverview_ui_strip_queue_cell(wsid);
+    if (g_current_preview)
+        gtk_widget_queue_draw(g_current_preview);
 }
 
 static void prune_empty_workspaces(void) {
@@ -134,13 +162,58 @@ static void clear_ui_state(void) {
     }
     g_active_count = 0;
     memset(g_active_list, 0, sizeof(g_active_list));
+    desperateOverview_ui_preview_layout_invalidate();
+}
+
+/* Workspaces whose cells need repainting after the last UI copy. */
+static gboolean g_ws_damaged[MAX_WS];
+
+/* What a cell shows of a workspace: window identity, geometry and
+ * thumbnail content. Titles and classes only reach the status label. */
+static guint32 workspace_signature(const WorkspaceWindows *W) {
+    guint32 hash = 2166136261u;
+    hash = (hash ^ (guint32)W->count) * 16777619u;
+    for (int i = 0; i < W->count; ++i) {
+        const WindowInfo *win = &W->wins[i];
+        const guint32 fields[] = {
+            g_str_hash(win->addr), (guint32)win->x, (guint32)win->y,
+            (guint32)win->w, (guint32)win->h, win->thumb_crc,
+            (guint32)win->focus_history_id, (guint32)win->floating,
+        };
+        for (size_t f = 0; f < G_N_ELEMENTS(fields); ++f)
+            hash = (hash ^ fields[f]) * 16777619u;
+    }
+    return hash;
+}
+
+static void queue_damaged_redraw(void) {
+    for (int i = 0; i < g_active_count; ++i) {
+        int wsid = g_active_list[i];
+        if (wsid > 0 && wsid < MAX_WS && g_ws_damaged[wsid])
+            desperateOverview_ui_strip_queue_cell(wsid);
+    }
+    if (g_current_preview && g_active_workspace > 0 && g_active_workspace < MAX_WS &&
+        g_ws_damaged[g_active_workspace])
+        gtk_widget_queue_draw(g_current_preview);
 }
 
 static void copy_core_state_to_ui(void) {
+    uint64_t span = desperateOverview_trace_begin();
+    uint64_t copy_start = desperateOverview_metrics_now_ns();
     CoreState snapshot;
     memset(&snapshot, 0, sizeof(snapshot));
     desperateOverview_core_copy_state(&snapshot);
 
+    guint32 old_signature[MAX_WS];
+    for (int wsid = 0; wsid < MAX_WS; ++wsid)
+        old_signature[wsid] = workspace_signature(&g_ws[wsid]);
+    int old_active = g_active_workspace;
+    gboolean monitor_changed = g_mon_width != snapshot.mon_width ||
+                               g_mon_height != snapshot.mon_height ||
+                               g_mon_off_x != snapshot.mon_off_x ||
+                               g_mon_off_y != snapshot.mon_off_y ||
+                               g_mon_transform != snapshot.mon_transform;
+
     clear_ui_state();
 
     g_mon_id       = snapshot.mon_id;
@@ -174,6 +247,8 @@ static void copy_core_state_to_ui(void) {
             dst->y = src->y;
             dst->w = src->w;
             dst->h = src->h;
+            dst->focus_history_id = src->focus_history_id;
+            dst->floating = src->floating;
             strncpy(dst->addr, src->addr, sizeof(dst->addr));
             dst->addr[sizeof(dst->addr) - 1] = '\0';
             dst->thumb_pixbuf = NULL;
@@ -187,6 +262,8 @@ static void copy_core_state_to_ui(void) {
             dst->title = src->title;
             src->title = NULL;
             dst->live_cookie = 0;
+            dst->capture_time_ns = src->capture_time_ns;
+            dst->capture_latency_ns = src->capture_latency_ns;
             dst->top_preview_valid = FALSE;
             dst->bottom_preview_valid = FALSE;
             dst->thumb_crc = 0;
@@ -199,9 +276,12 @@ static void copy_core_state_to_ui(void) {
                     cached = desperateOverview_thumb_cache_lookup(dst->addr, new_crc, cache_generation);
                 }
                 if (cached) {
+                    desperateOverview_metrics_count(DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_HIT);
                     dst->thumb_pixbuf = cached;
                     continue;
                 }
+                desperateOverview_metrics_count(DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_MISS);
+                uint64_t decode_start = desperateOverview_metrics_now_ns();
                 gsize raw_len = 0;
                 guchar *raw = g_base64_decode(dst->thumb_b64, &raw_len);
                 if (raw && raw_len > 0) {
@@ -221,18 +301,41 @@ static void copy_core_state_to_ui(void) {
                 }
                 if (raw)
                     g_free(raw);
+                desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_THUMB_DECODE, decode_start);
             }
         }
     }
 
     if (cache_active)
         desperateOverview_thumb_cache_prune(cache_generation);
+    desperateOverview_surface_cache_prune();
+    desperateOverview_ui_moves_reconcile();
+
+    for (int wsid = 0; wsid < MAX_WS; ++wsid) {
+        gboolean active_moved = old_active != g_active_workspace &&
+                                (wsid == old_active || wsid == g_active_workspace);
+        g_ws_damaged[wsid] = monitor_changed || active_moved ||
+                             workspace_signature(&g_ws[wsid]) != old_signature[wsid];
+    }
 
     if (g_overlay_visible || g_force_live_previews)
         desperateOverview_ui_build_live_previews(g_active_workspace, g_ws);
 
     desperateOverview_core_free_state(&snapshot);
     reset_interaction_state();
+    if (g_overlay_visible)
+        desperateOverview_ui_preview_layout_refresh();
+
+    desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_UI_COPY, copy_start);
+    uint64_t event_ns = desperateOverview_metrics_mark_take(DESPERATEOVERVIEW_MARK_EVENT);
+    if (event_ns) {
+        desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_EVENT_TO_UI, event_ns);
+        /* Only a visible overlay draws the new state; otherwise the
+         * event-to-frame latency is not meaningful. */
+        if (g_overlay_visible)
+            desperateOverview_metrics_mark_set(DESPERATEOVERVIEW_MARK_EVENT_APPLIED, event_ns);
+    }
+    desperateOverview_trace_end("ui_copy", span, NULL);
 }
 
 static gboolean point_inside_widget(GtkWidget *target, GtkWidget *relative_to, double px, double py) {
@@ -265,7 +368,7 @@ static gboolean on_overlay_window_button_press(GtkWidget *widget, GdkEventButton
     gboolean inside_bottom = point_inside_widget(g_current_preview, widget, event->x, event->y);
 
     if (!inside_top && !inside_bottom) {
-        close_overlay();
+        dismiss_overlay();
         return TRUE;
     }
     return FALSE;
@@ -273,8 +376,15 @@ static gboolean on_overlay_window_button_press(GtkWidget *widget, GdkEventButton
 
 static gboolean show_overlay_idle(gpointer data) {
     (void)data;
-    if (g_overlay_visible)
+    if (g_overlay_visible) {
+        desperateOverview_metrics_mark_take(DESPERATEOVERVIEW_MARK_SHOW);
+        if (g_overlay_closing && g_overlay_window) {
+            g_overlay_closing = FALSE;
+            start_fade(g_overlay_window, 1.0, fade_in_done);
+        }
         return G_SOURCE_REMOVE;
+    }
+    desperateOverview_ui_layout_prime_capture();
     desperateOverview_core_set_thumbnail_capture_enabled(true);
     if (desperateOverview_core_state_needs_refresh())
         desperateOverview_core_request_full_refresh();
@@ -282,7 +392,11 @@ static gboolean show_overlay_idle(gpointer data) {
     g_force_live_previews = TRUE;
     copy_core_state_to_ui();
     prune_empty_workspaces();
+    uint64_t build_start = desperateOverview_metrics_now_ns();
+    uint64_t span = desperateOverview_trace_begin();
     g_overlay_window = build_overlay_window();
+    desperateOverview_trace_end("overlay_build", span, NULL);
+    desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_OVERLAY_BUILD, build_start);
     g_overlay_visible = TRUE;
     desperateOverview_ui_build_live_previews(g_active_workspace, g_ws);
     return G_SOURCE_REMOVE;
@@ -290,7 +404,7 @@ static gboolean show_overlay_idle(gpointer data) {
 
 static gboolean hide_overlay_idle(gpointer data) {
     (void)data;
-    close_overlay();
+    dismiss_overlay();
     return G_SOURCE_REMOVE;
 }
 
@@ -326,20 +440,19 @@ static gboolean active_layout_changed(void) {
 
 static gboolean overlay_idle_redraw(gpointer data) {
     (void)data;
+    uint64_t span = desperateOverview_trace_begin();
     g_mutex_lock(&g_redraw_lock);
     g_redraw_pending = FALSE;
     g_mutex_unlock(&g_redraw_lock);
 
     copy_core_state_to_ui();
     prune_empty_workspaces();
-    if (!g_overlay_visible)
-        return G_SOURCE_REMOVE;
-
-    if (active_layout_changed()) {
-        desperateOverview_ui_rebuild_overlay_content();
-    } else {
-        desperateOverview_ui_queue_cells_redraw();
+    if (g_overlay_visible) {
+        if (active_layout_changed())
+            desperateOverview_ui_rebuild_overlay_content();
+        queue_damaged_redraw();
     }
+    desperateOverview_trace_end("overlay_idle_redraw", span, NULL);
     return G_SOURCE_REMOVE;
 }
 
@@ -350,8 +463,9 @@ static void handle_live_preview_ready(WindowInfo *win, GdkPixbuf *pixbuf, gpoint
     if (win->live_pixbuf)
         g_object_unref(win->live_pixbuf);
     win->live_pixbuf = pixbuf ? g_object_ref(pixbuf) : NULL;
+    /* Cells paint the thumbnail, so only the current preview shows it. */
     if (g_overlay_visible)
-        desperateOverview_ui_queue_cells_redraw();
+        desperateOverview_ui_queue_window_redraw(win, FALSE, TRUE);
 }
 
 void desperateOverview_ui_core_redraw_callback(void *user_data) {
@@ -364,23 +478,98 @@ void desperateOverview_ui_core_redraw_callback(void *user_data) {
     g_mutex_unlock(&g_redraw_lock);
 }
 
-static gboolean fade_in_cb(gpointer data) {
-    GtkWidget *window = GTK_WIDGET(data);
-    if (!GTK_IS_WIDGET(window)) {
-        g_fade_source_id = 0;
-        return FALSE;
-    }
-    double op = gtk_widget_get_opacity(window);
+/* Fades run on the window's frame clock. fade_step keeps its meaning as
+ * the opacity gained per 16 ms, which sets the fade duration. */
+static double   g_fade_from = 0.0;
+static double   g_fade_to = 1.0;
+static guint    g_slide_anim_id = 0;
+
+static guint fade_duration_ms(double from, double to) {
     const OverlayConfig *cfg = config_get();
     double step = (cfg && cfg->fade_step > 0.0) ? cfg->fade_step : 0.08;
-    op += step;
-    if (op >= 1.0) {
-        gtk_widget_set_opacity(window, 1.0);
-        g_fade_source_id = 0;
-        return FALSE;
+    double distance = fabs(to - from);
+    return (guint)ceil(distance / step * 16.0);
+}
+
+static void fade_step_cb(double value, gpointer data) {
+    GtkWidget *window = GTK_WIDGET(data);
+    gtk_widget_set_opacity(window, g_fade_from + (g_fade_to - g_fade_from) * value);
+}
+
+static void fade_in_done(gboolean finished, gpointer data) {
+    (void)finished; (void)data;
+    g_fade_anim_id = 0;
+}
+
+static gboolean close_overlay_idle(gpointer data) {
+    (void)data;
+    if (g_overlay_closing)
+        close_overlay();
+    return G_SOURCE_REMOVE;
+}
+
+/* Closing destroys the window whose tick callback is running, so it is
+ * left to an idle. */
+static void fade_out_done(gboolean finished, gpointer data) {
+    (void)data;
+    g_fade_anim_id = 0;
+    if (finished && g_overlay_closing)
+        g_idle_add(close_overlay_idle, NULL);
+}
+
+static void start_fade(GtkWidget *window, double to, DesperateOverviewAnimDone done) {
+    if (g_fade_anim_id)
+        desperateOverview_anim_cancel(g_fade_anim_id);
+    g_fade_from = gtk_widget_get_opacity(window);
+    g_fade_to = to;
+    g_fade_anim_id = desperateOverview_anim_start(window, fade_duration_ms(g_fade_from, to),
+                                                  DESPERATEOVERVIEW_EASE_OUT_CUBIC,
+                                                  fade_step_cb, done, window);
+}
+
+/* Fades the overlay out and closes it; a show request in the meantime
+ * fades it back in. Falls back to closing at once if the window cannot
+ * animate. */
+void dismiss_overlay(void) {
+    if (!g_overlay_window || g_overlay_closing)
+        return;
+    g_overlay_closing = TRUE;
+    start_fade(g_overlay_window, 0.0, fade_out_done);
+    if (!g_fade_anim_id)
+        close_overlay();
+}
+
+static void slide_step_cb(double value, gpointer data) {
+    double from = *(double *)data;
+    desperateOverview_ui_render_set_current_slide(from * (1.0 - value));
+    if (g_current_preview)
+        gtk_widget_queue_draw(g_current_preview);
+}
+
+static void slide_done(gboolean finished, gpointer data) {
+    (void)finished;
+    g_free(data);
+    g_slide_anim_id = 0;
+    desperateOverview_ui_render_set_current_slide(0.0);
+}
+
+/* Slides the current-workspace preview in from the side of the workspace
+ * that was left. */
+static void start_workspace_slide(int old_idx, int new_idx) {
+    if (g_slide_anim_id)
+        desperateOverview_anim_cancel(g_slide_anim_id);
+    if (!g_current_preview || old_idx < 0 || new_idx < 0 || old_idx == new_idx)
+        return;
+    double *from = g_new(double, 1);
+    *from = new_idx > old_idx ? 0.12 : -0.12;
+    desperateOverview_ui_render_set_current_slide(*from);
+    g_slide_anim_id = desperateOverview_anim_start(g_current_preview, 180,
+                                                   DESPERATEOVERVIEW_EASE_OUT_CUBIC,
+                                                   slide_step_cb, slide_done, from);
+    if (!g_slide_anim_id) {
+        g_free(from);
+        desperateOverview_ui_render_set_current_slide(0.0);
     }
-    gtk_widget_set_opacity(window, op);
-    return TRUE;
 }
 
 static GtkWidget *build_overlay_window(void) {
@@ -411,16 +600,17 @@ static GtkWidget *build_overlay_window(void) {
     g_root_box = root_box;
 
     desperateOverview_ui_build_overlay_content(root_box);
+    desperateOverview_ui_drag_layer_attach(root_overlay);
+    desperateOverview_ui_hud_attach(root_overlay);
 
     gtk_widget_set_opacity(window, 0.0);
     gtk_widget_show_all(window);
     gtk_window_present(GTK_WINDOW(window));
     g_signal_connect(window, "destroy", G_CALLBACK(on_overlay_destroy), NULL);
-    if (g_fade_source_id) {
-        g_source_remove(g_fade_source_id);
-        g_fade_source_id = 0;
-    }
-    g_fade_source_id = g_timeout_add(16, fade_in_cb, window);
+    g_overlay_closing = FALSE;
+    start_fade(window, 1.0, fade_in_done);
+    if (!g_fade_anim_id)
+        gtk_widget_set_opacity(window, 1.0);
     g_built_active_count = g_active_count;
     memcpy(g_built_active_list, g_active_list, sizeof(g_active_list));
     for (int i = 0; i < g_active_count && i < MAX_WS; ++i) {
@@ -437,6 +627,10 @@ void close_overlay(void) {
 
     desperateOverview_core_set_thumbnail_capture_enabled(false);
     desperateOverview_ui_cancel_drag_hold_timer();
+    desperateOverview_ui_hud_detach();
+    desperateOverview_ui_drag_layer_detach();
+    desperateOverview_ui_render_invalidate_cells();
+    desperateOverview_ui_selection_clear();
     reset_interaction_state();
     g_overlay_content = NULL;
     g_current_preview = NULL;
@@ -444,11 +638,14 @@ void close_overlay(void) {
     g_root_box = NULL;
     g_root_overlay = NULL;
     g_new_ws_target = NULL;
+    g_cell_strip = NULL;
 
-    if (g_fade_source_id) {
-        g_source_remove(g_fade_source_id);
-        g_fade_source_id = 0;
-    }
+    g_overlay_closing = FALSE;
+    desperateOverview_anim_cancel(g_fade_anim_id);
+    desperateOverview_anim_cancel(g_slide_anim_id);
+
+    desperateOverview_metrics_mark_take(DESPERATEOVERVIEW_MARK_SHOW);
+    desperateOverview_metrics_mark_take(DESPERATEOVERVIEW_MARK_EVENT_APPLIED);
 
     GtkWidget *window = g_overlay_window;
     g_overlay_window = NULL;
@@ -462,37 +659,15 @@ static void on_overlay_destroy(GtkWidget *widget, gpointer data) {
     (void)data;
     if (g_overlay_window == widget)
         g_overlay_window = NULL;
+    g_overlay_closing = FALSE;
+    desperateOverview_ui_hud_detach();
+    desperateOverview_ui_render_invalidate_cells();
     g_overlay_visible = FALSE;
     g_status_label = NULL;
     g_root_box = NULL;
     g_root_overlay = NULL;
 }
 
-static GdkMonitor *match_monitor_for_window(GtkWidget *window) {
-    GdkDisplay *display = gtk_widget_get_display(window);
-    if (!display)
-        return NULL;
-
-    int eff_w = desperateOverview_ui_get_effective_mon_width();
-    int eff_h = desperateOverview_ui_get_effective_mon_height();
-    int monitors = gdk_display_get_n_monitors(display);
-    for (int i = 0; i < monitors; ++i) {
-        GdkMonitor *monitor = gdk_display_get_monitor(display, i);
-        if (!monitor)
-            continue;
-        GdkRectangle rect;
-        gdk_monitor_get_geometry(monitor, &rect);
-        if (rect.x == g_mon_off_x &&
-            rect.y == g_mon_off_y &&
-            rect.width == eff_w &&
-            rect.height == eff_h) {
-            return monitor;
-        }
-    }
-
-    return gdk_display_get_primary_monitor(display);
-}
-
 static void configure_layer_shell(GtkWindow *window) {
     gtk_layer_init_for_window(window);
     gtk_layer_set_layer(window, GTK_LAYER_SHELL_LAYER_OVERLAY);
@@ -504,7 +679,7 @@ static void configure_layer_shell(GtkWindow *window) {
     gtk_layer_set_exclusive_zone(window, 0);
     gtk_layer_set_keyboard_interactivity(window, TRUE);
 
-    GdkMonitor *monitor = match_monitor_for_window(GTK_WIDGET(window));
+    GdkMonitor *monitor = desperateOverview_ui_match_monitor(gtk_widget_get_display(GTK_WIDGET(window)));
     if (monitor)
         gtk_layer_set_monitor(window, monitor);
 }
@@ -518,6 +693,7 @@ void desperateOverview_ui_init(const char *config_path) {
     config_init(config_path);
     desperateOverview_css_init();
     desperateOverview_thumb_cache_init();
+    desperateOverview_surface_cache_init();
     desperateOverview_core_set_thumbnail_capture_enabled(false);
 }
 
@@ -527,6 +703,7 @@ void desperateOverview_ui_shutdown(void) {
     config_shutdown();
     desperateOverview_css_shutdown();
     desperateOverview_thumb_cache_shutdown();
+    desperateOverview_surface_cache_shutdown();
     g_mutex_clear(&g_redraw_lock);
 }
 
@@ -535,6 +712,7 @@ void desperateOverview_ui_sync_with_core(void) {
 }
 
 void desperateOverview_ui_request_show(void) {
+    desperateOverview_metrics_mark_set(DESPERATEOVERVIEW_MARK_SHOW, desperateOverview_metrics_now_ns());
     g_idle_add(show_overlay_idle, NULL);
 }
 
@@ -0,0 +1,195 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_anim.h"
+
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
+
+typedef struct {
+    guint id;
+    GtkWidget *widget;
+    gint64 duration_us;
+    gint64 start_us;        /* 0 until the first frame */
+    DesperateOverviewEasing easing;
+    DesperateOverviewAnimStep step;
+    DesperateOverviewAnimDone done;
+    gpointer user_data;
+} Anim;
+
+/* One tick callback per widget, shared by its animations. */
+typedef struct {
+    GtkWidget *widget;
+    guint tick_id;
+    gint64 last_frame_us;
+} AnimTicker;
+
+static GList *g_anims = NULL;      /* Anim* */
+static GList *g_tickers = NULL;    /* AnimTicker* */
+static guint  g_next_anim_id = 1;
+
+double desperateOverview_anim_ease(DesperateOverviewEasing easing, double t) {
+    if (t <= 0.0)
+        return 0.0;
+    if (t >= 1.0)
+        return 1.0;
+    switch (easing) {
+        case DESPERATEOVERVIEW_EASE_OUT_CUBIC: {
+            double u = 1.0 - t;
+            return 1.0 - u * u * u;
+        }
+        case DESPERATEOVERVIEW_EASE_IN_OUT_CUBIC:
+            if (t < 0.5)
+                return 4.0 * t * t * t;
+            else {
+                double u = -2.0 * t + 2.0;
+                return 1.0 - u * u * u / 2.0;
+            }
+        case DESPERATEOVERVIEW_EASE_LINEAR:
+        default:
+            return t;
+    }
+}
+
+static AnimTicker *find_ticker(GtkWidget *widget) {
+    for (GList *l = g_tickers; l; l = l->next) {
+        AnimTicker *ticker = l->data;
+        if (ticker->widget == widget)
+            return ticker;
+    }
+    return NULL;
+}
+
+static gboolean widget_has_anims(GtkWidget *widget) {
+    for (GList *l = g_anims; l; l = l->next) {
+        if (((Anim *)l->data)->widget == widget)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static Anim *find_anim(guint id) {
+    for (GList *l = g_anims; l; l = l->next) {
+        Anim *anim = l->data;
+        if (anim->id == id)
+            return anim;
+    }
+    return NULL;
+}
+
+static void finish_anim(Anim *anim, gboolean finished) {
+    g_anims = g_list_remove(g_anims, anim);
+    if (anim->done)
+        anim->done(finished, anim->user_data);
+    g_free(anim);
+}
+
+/* GTK calls this when the tick callback is removed, including when the
+ * widget is destroyed; any animation still attached is cancelled. */
+static void ticker_destroyed(gpointer data) {
+    AnimTicker *ticker = data;
+    g_tickers = g_list_remove(g_tickers, ticker);
+    GList *l = g_anims;
+    while (l) {
+        GList *next = l->next;
+        Anim *anim = l->data;
+        if (anim->widget == ticker->widget)
+            finish_anim(anim, FALSE);
+        l = next;
+    }
+    g_free(ticker);
+}
+
+static gboolean ticker_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+    AnimTicker *ticker = data;
+    gint64 now = gdk_frame_clock_get_frame_time(clock);
+    if (ticker->last_frame_us > 0 && now > ticker->last_frame_us)
+        desperateOverview_metrics_record(DESPERATEOVERVIEW_METRIC_ANIM_FRAME_INTERVAL,
+                                         (uint64_t)(now - ticker->last_frame_us) * 1000u);
+    ticker->last_frame_us = now;
+
+    /* Step callbacks may start or cancel animations, so walk a snapshot of
+     * ids and look each one up again. */
+    uint64_t span = desperateOverview_trace_begin();
+    GSList *ids = NULL;
+    for (GList *l = g_anims; l; l = l->next) {
+        Anim *anim = l->data;
+        if (anim->widget == widget)
+            ids = g_slist_prepend(ids, GUINT_TO_POINTER(anim->id));
+    }
+    ids = g_slist_reverse(ids);
+    for (GSList *l = ids; l; l = l->next) {
+        guint id = GPOINTER_TO_UINT(l->data);
+        Anim *anim = find_anim(id);
+        if (!anim)
+            continue;
+        if (anim->start_us == 0)
+            anim->start_us = now;
+        double t = anim->duration_us > 0
+                   ? (double)(now - anim->start_us) / (double)anim->duration_us
+                   : 1.0;
+        if (anim->step)
+            anim->step(desperateOverview_anim_ease(anim->easing, t), anim->user_data);
+        anim = find_anim(id);
+        if (anim && t >= 1.0)
+            finish_anim(anim, TRUE);
+    }
+    g_slist_free(ids);
+    desperateOverview_trace_end("anim_tick", span, NULL);
+
+    if (widget_has_anims(widget))
+        return G_SOURCE_CONTINUE;
+    /* Returning REMOVE runs ticker_destroyed, which finds nothing left. */
+    ticker->tick_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+guint desperateOverview_anim_start(GtkWidget *widget,
+                                   guint duration_ms,
+                                   DesperateOverviewEasing easing,
+                                   DesperateOverviewAnimStep step,
+                                   DesperateOverviewAnimDone done,
+                                   gpointer user_data) {
+    if (!widget || !GTK_IS_WIDGET(widget) || gtk_widget_in_destruction(widget))
+        return 0;
+
+    AnimTicker *ticker = find_ticker(widget);
+    if (!ticker) {
+        ticker = g_new0(AnimTicker, 1);
+        ticker->widget = widget;
+        g_tickers = g_list_prepend(g_tickers, ticker);
+        ticker->tick_id = gtk_widget_add_tick_callback(widget, ticker_tick, ticker, ticker_destroyed);
+    }
+
+    Anim *anim = g_new0(Anim, 1);
+    anim->id = g_next_anim_id++;
+    if (g_next_anim_id == 0)
+        g_next_anim_id = 1;
+    anim->widget = widget;
+    anim->duration_us = (gint64)duration_ms * 1000;
+    anim->easing = easing;
+    anim->step = step;
+    anim->done = done;
+    anim->user_data = user_data;
+    g_anims = g_list_append(g_anims, anim);
+    return anim->id;
+}
+
+void desperateOverview_anim_cancel(guint id) {
+    Anim *anim = id ? find_anim(id) : NULL;
+    if (anim)
+        finish_anim(anim, FALSE);
+    /* The ticker notices on its next frame and removes itself. */
+}
+
+void desperateOverview_anim_cancel_widget(GtkWidget *widget) {
+    AnimTicker *ticker = widget ? find_ticker(widget) : NULL;
+    if (ticker && ticker->tick_id) {
+        guint tick_id = ticker->tick_id;
+        ticker->tick_id = 0;
+        gtk_widget_remove_tick_callback(widget, tick_id);   /* runs ticker_destroyed */
+    }
+}
+
+gboolean desperateOverview_anim_is_running(guint id) {
+    return id && find_anim(id) != NULL;
+}
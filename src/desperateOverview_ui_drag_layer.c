@@ -0,0 +1,174 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_drag_layer.h"
+
+#include <math.h>
+
+#include "desperateOverview_ui_render.h"
+#include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_strip.h"
+#include "desperateOverview_trace.h"
+
+/* Covers the 4px drop frame and the dashed outline, plus antialiasing. */
+#define DRAG_LAYER_MARGIN 4.0
+
+typedef enum {
+    DRAG_MARK_DROP_CELL,
+    DRAG_MARK_WINDOW
+} DragMarkKind;
+
+/* One piece of feedback in layer coordinates, clipped to the part of the
+ * source view that is on screen. */
+typedef struct {
+    DragMarkKind kind;
+    double x, y, w, h;
+    GdkRectangle clip;
+} DragMark;
+
+#define DRAG_LAYER_MAX_MARKS 3
+
+static GtkWidget *g_drag_layer = NULL;
+static DragMark   g_drawn_marks[DRAG_LAYER_MAX_MARKS];
+static int        g_drawn_count = 0;
+
+/* Allocation of `view` in layer coordinates. */
+static gboolean view_rect(GtkWidget *view, GdkRectangle *out) {
+    if (!view || !g_drag_layer || !gtk_widget_get_mapped(view))
+        return FALSE;
+    int x, y;
+    if (!gtk_widget_translate_coordinates(view, g_drag_layer, 0, 0, &x, &y))
+        return FALSE;
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(view, &alloc);
+    out->x = x;
+    out->y = y;
+    out->width = alloc.width;
+    out->height = alloc.height;
+    return TRUE;
+}
+
+/* In scroll mode only the scroller's viewport of the strip is visible. */
+static gboolean strip_clip(GdkRectangle *out) {
+    GtkWidget *scroller = g_cell_strip
+        ? gtk_widget_get_ancestor(g_cell_strip, GTK_TYPE_SCROLLED_WINDOW)
+        : NULL;
+    return view_rect(scroller ? scroller : g_cell_strip, out);
+}
+
+static int add_mark(DragMark *marks, int count, DragMarkKind kind,
+                    double x, double y, double w, double h, const GdkRectangle *clip) {
+    if (count >= DRAG_LAYER_MAX_MARKS || w <= 0 || h <= 0)
+        return count;
+    DragMark *mark = &marks[count];
+    mark->kind = kind;
+    mark->x = x;
+    mark->y = y;
+    mark->w = w;
+    mark->h = h;
+    mark->clip = *clip;
+    return count + 1;
+}
+
+/* The feedback for the current drag state, from the precomputed preview
+ * rects; nothing is laid out here. */
+static int collect_marks(DragMark *marks) {
+    int count = 0;
+    if (!g_drag.in_progress)
+        return 0;
+
+    GdkRectangle clip, preview;
+    int sx, sy;
+    gboolean have_strip = strip_clip(&clip) &&
+        gtk_widget_translate_coordinates(g_cell_strip, g_drag_layer, 0, 0, &sx, &sy);
+    double cell_w, cell_h, cx, cy;
+    desperateOverview_ui_strip_get_cell_size(&cell_w, &cell_h);
+
+    int drop_ws = desperateOverview_ui_strip_drop_target();
+    if (have_strip && drop_ws > 0 && desperateOverview_ui_strip_cell_origin(drop_ws, &cx, &cy))
+        count = add_mark(marks, count, DRAG_MARK_DROP_CELL,
+                         sx + cx, sy + cy, cell_w, cell_h, &clip);
+
+    WindowInfo *win = g_drag.active_window;
+    int wsid = desperateOverview_ui_find_window_workspace(win);
+    if (wsid <= 0)
+        return count;
+    if (have_strip && win->top_preview_valid &&
+        desperateOverview_ui_strip_cell_origin(wsid, &cx, &cy))
+        count = add_mark(marks, count, DRAG_MARK_WINDOW,
+                         sx + cx + win->top_preview_x, sy + cy + win->top_preview_y,
+                         win->top_preview_w, win->top_preview_h, &clip);
+    if (wsid == g_active_workspace && win->bottom_preview_valid &&
+        view_rect(g_current_preview, &preview))
+        count = add_mark(marks, count, DRAG_MARK_WINDOW,
+                         preview.x + win->bottom_preview_x, preview.y + win->bottom_preview_y,
+                         win->bottom_preview_w, win->bottom_preview_h, &preview);
+    return count;
+}
+
+static void queue_mark(const DragMark *mark) {
+    GdkRectangle r;
+    r.x = (int)floor(mark->x - DRAG_LAYER_MARGIN);
+    r.y = (int)floor(mark->y - DRAG_LAYER_MARGIN);
+    r.width = (int)ceil(mark->x + mark->w + DRAG_LAYER_MARGIN) - r.x;
+    r.height = (int)ceil(mark->y + mark->h + DRAG_LAYER_MARGIN) - r.y;
+    if (gdk_rectangle_intersect(&r, &mark->clip, &r))
+        gtk_widget_queue_draw_area(g_drag_layer, r.x, r.y, r.width, r.height);
+}
+
+static gboolean drag_layer_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
+    (void)widget; (void)data;
+    uint64_t span = desperateOverview_trace_begin();
+    g_drawn_count = collect_marks(g_drawn_marks);
+    for (int i = 0; i < g_drawn_count; ++i) {
+        const DragMark *mark = &g_drawn_marks[i];
+        cairo_save(cr);
+        cairo_rectangle(cr, mark->clip.x, mark->clip.y, mark->clip.width, mark->clip.height);
+        cairo_clip(cr);
+        if (mark->kind == DRAG_MARK_DROP_CELL) {
+            cairo_translate(cr, mark->x, mark->y);
+            desperateOverview_ui_render_drop_target(cr, mark->w, mark->h);
+        } else {
+            desperateOverview_ui_render_drag_window(cr, mark->x, mark->y, mark->w, mark->h);
+        }
+        cairo_restore(cr);
+    }
+    desperateOverview_trace_end("drag_layer_draw", span, NULL);
+    return FALSE;
+}
+
+static void on_drag_layer_destroy(GtkWidget *widget, gpointer data) {
+    (void)data;
+    if (g_drag_layer == widget)
+        desperateOverview_ui_drag_layer_detach();
+}
+
+void desperateOverview_ui_drag_layer_attach(GtkWidget *root_overlay) {
+    if (!root_overlay)
+        return;
+    desperateOverview_ui_drag_layer_detach();
+
+    GtkWidget *area = gtk_drawing_area_new();
+    gtk_widget_set_hexpand(area, TRUE);
+    gtk_widget_set_vexpand(area, TRUE);
+    g_signal_connect(area, "draw", G_CALLBACK(drag_layer_draw), NULL);
+    g_signal_connect(area, "destroy", G_CALLBACK(on_drag_layer_destroy), NULL);
+    gtk_overlay_add_overlay(GTK_OVERLAY(root_overlay), area);
+    gtk_overlay_set_overlay_pass_through(GTK_OVERLAY(root_overlay), area, TRUE);
+    g_drag_layer = area;
+}
+
+void desperateOverview_ui_drag_layer_detach(void) {
+    g_drag_layer = NULL;
+    g_drawn_count = 0;
+}
+
+void desperateOverview_ui_drag_layer_update(void) {
+    if (!g_drag_layer)
+        return;
+    for (int i = 0; i < g_drawn_count; ++i)
+        queue_mark(&g_drawn_marks[i]);
+    DragMark marks[DRAG_LAYER_MAX_MARKS];
+    int count = collect_marks(marks);
+    for (int i = 0; i < count; ++i)
+        queue_mark(&marks[i]);
+}
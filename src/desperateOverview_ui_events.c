@@ -7,12 +7,18 @@
 
 #include "desperateOverview_core.h"
 #include "desperateOverview_config.h"
-#include "desperateOverview_geometry.h"
+#include "desperateOverview_ui_anim.h"
 #include "desperateOverview_ui_drag.h"
+#include "desperateOverview_ui_drag_layer.h"
+#include "desperateOverview_ui_hud.h"
+#include "desperateOverview_ui_moves.h"
+#include "desperateOverview_ui_preview_layout.h"
 #include "desperateOverview_ui_render.h"
 #include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_strip.h"
+#include "desperateOverview_ui_surface_cache.h"
 
-extern void close_overlay(void);
+extern void dismiss_overlay(void);
 
 static const double G_DRAG_HOLD_MOVE_THRESHOLD = 3.0;
 
@@ -27,6 +33,32 @@ static void follow_drop_to_workspace(int target_ws) {
     desperateOverview_core_switch_workspace(name, target_ws);
 }
 
+static guint g_drop_flash_ids[MAX_WS];
+
+static void drop_flash_step(double value, gpointer data) {
+    int wsid = GPOINTER_TO_INT(data);
+    desperateOverview_ui_render_set_cell_flash(wsid, 1.0 - value);
+    desperateOverview_ui_strip_queue_cell(wsid);
+}
+
+static void drop_flash_done(gboolean finished, gpointer data) {
+    (void)finished;
+    int wsid = GPOINTER_TO_INT(data);
+    g_drop_flash_ids[wsid] = 0;
+    desperateOverview_ui_render_set_cell_flash(wsid, 0.0);
+}
+
+/* Pulses the border of the cell a window was dropped on. */
+static void start_drop_flash(int wsid) {
+    if (wsid <= 0 || wsid >= MAX_WS)
+        return;
+    desperateOverview_anim_cancel(g_drop_flash_ids[wsid]);
+    g_drop_flash_ids[wsid] = desperateOverview_anim_start(g_cell_strip, 320,
+                                                          DESPERATEOVERVIEW_EASE_OUT_CUBIC,
+                                                          drop_flash_step, drop_flash_done,
+                                                          GINT_TO_POINTER(wsid));
+}
+
 static int resolve_workspace_id(gpointer data) {
     int wsid = GPOINTER_TO_INT(data);
     if (wsid == 0)
@@ -34,34 +66,37 @@ static int resolve_workspace_id(gpointer data) {
     return wsid;
 }
 
+/* Maps a pointer position to the workspace under it and to coordinates in
+ * that workspace's preview: the strip hit-tests its cells, the current
+ * preview always shows the active workspace. */
+static int locate_workspace(GtkWidget *widget, gpointer data, double x, double y,
+                            double *local_x, double *local_y) {
+    if (widget && widget == g_cell_strip)
+        return desperateOverview_ui_strip_cell_at(x, y, local_x, local_y);
+    *local_x = x;
+    *local_y = y;
+    return resolve_workspace_id(data);
+}
+
+/* Hit-tests the precomputed layout of the view, laying it out first if a
+ * state change or resize has not been drawn yet. */
 static WindowInfo *hit_test_window_view(int wsid, double px, double py, gboolean bottom_view) {
     if (wsid <= 0 || wsid >= MAX_WS)
         return NULL;
 
-    WorkspaceWindows *W = &g_ws[wsid];
-    for (int i = 0; i < W->count; ++i) {
-        WindowInfo *win = &W->wins[i];
-        double x0, y0, w, h;
-        gboolean valid = bottom_view ? win->bottom_preview_valid : win->top_preview_valid;
-        if (!valid)
-            continue;
-        if (bottom_view) {
-            x0 = win->bottom_preview_x;
-            y0 = win->bottom_preview_y;
-            w = win->bottom_preview_w;
-            h = win->bottom_preview_h;
-        } else {
-            x0 = win->top_preview_x;
-            y0 = win->top_preview_y;
-            w = win->top_preview_w;
-            h = win->top_preview_h;
-        }
-        double x1 = x0 + w;
-        double y1 = y0 + h;
-        if (px >= x0 && px <= x1 && py >= y0 && py <= y1)
-            return win;
+    const DesperateOverviewPreviewLayout *layout = NULL;
+    if (bottom_view) {
+        if (!g_current_preview || wsid != g_active_workspace)
+            return NULL;
+        GtkAllocation alloc;
+        gtk_widget_get_allocation(g_current_preview, &alloc);
+        layout = desperateOverview_ui_preview_layout_current(alloc.width, alloc.height);
+    } else {
+        double cell_w, cell_h;
+        desperateOverview_ui_strip_get_cell_size(&cell_w, &cell_h);
+        layout = desperateOverview_ui_preview_layout_cell(wsid, cell_w, cell_h);
     }
-    return NULL;
+    return desperateOverview_ui_preview_layout_hit(layout, px, py);
 }
 
 static gchar *build_window_hover_text(const WindowInfo *win) {
@@ -117,7 +152,7 @@ static gboolean drag_hold_timeout_cb(DragState *drag, gpointer data) {
     );
     gtk_target_list_unref(list);
 
-    desperateOverview_ui_queue_cells_redraw();
+    desperateOverview_ui_drag_layer_update();
     ui_drag_cancel_hold(drag);
     return G_SOURCE_REMOVE;
 }
@@ -140,8 +175,9 @@ void desperateOverview_ui_cancel_drag_hold_timer(void) {
 
 gboolean desperateOverview_ui_on_cell_motion(GtkWidget *widget, GdkEventMotion *event, gpointer data) {
     gboolean bottom_view = (widget == g_current_preview);
-    int wsid = resolve_workspace_id(data);
-    WindowInfo *hit = hit_test_window_view(wsid, event->x, event->y, bottom_view);
+    double lx, ly;
+    int wsid = locate_workspace(widget, data, event->x, event->y, &lx, &ly);
+    WindowInfo *hit = hit_test_window_view(wsid, lx, ly, bottom_view);
     desperateOverview_ui_set_hover_window(hit, bottom_view);
 
     if (g_drag.hold_source_id && widget == g_drag.hold_widget) {
@@ -162,65 +198,18 @@ gboolean desperateOverview_ui_on_cell_leave(GtkWidget *widget, GdkEventCrossing
     return FALSE;
 }
 
+/* The icon comes from the surface cache at icon size; no thumbnail-sized
+ * pixel work happens on drag begin. */
 static void set_drag_icon_from_window(GdkDragContext *context, WindowInfo *win) {
     if (!context || !win)
         return;
 
-    GdkPixbuf *icon = NULL;
-
-    if (win->thumb_pixbuf) {
-        GdkPixbuf *source = desperateOverview_ui_orient_pixbuf(win->thumb_pixbuf);
-        if (source) {
-            int src_w = gdk_pixbuf_get_width(source);
-            int src_h = gdk_pixbuf_get_height(source);
-            if (src_w > 0 && src_h > 0) {
-                int target_w = src_w;
-                int target_h = src_h;
-                const int max_dim = 320;
-                const int min_dim = 48;
-
-                if (src_w > max_dim || src_h > max_dim) {
-                    double sx = (double)max_dim / (double)src_w;
-                    double sy = (double)max_dim / (double)src_h;
-                    double scale = (sx < sy) ? sx : sy;
-                    target_w = (int)((double)src_w * scale + 0.5);
-                    target_h = (int)((double)src_h * scale + 0.5);
-                }
-
-                target_w = desperateOverview_geometry_clamp_int(target_w, min_dim, max_dim);
-                target_h = desperateOverview_geometry_clamp_int(target_h, min_dim, max_dim);
-
-                if (target_w == src_w && target_h == src_h) {
-                    icon = source;
-                    source = NULL;
-                } else {
-                    icon = gdk_pixbuf_scale_simple(
-                        source,
-                        target_w,
-                        target_h,
-                        GDK_INTERP_BILINEAR
-                    );
-                }
-            }
-            if (source)
-                g_object_unref(source);
-        }
-    }
-
-    if (!icon) {
-        int w = 200;
-        int h = 120;
-        icon = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, w, h);
-        if (icon) {
-            gdk_pixbuf_fill(icon, 0x44aaff88);
-        }
-    }
-
+    const int max_dim = 320;
+    const int min_dim = 48;
+    cairo_surface_t *icon = desperateOverview_surface_cache_get_drag_icon(win->addr, max_dim, min_dim);
     if (icon) {
-        int hot_x = gdk_pixbuf_get_width(icon) / 2;
-        int hot_y = gdk_pixbuf_get_height(icon) / 2;
-        gtk_drag_set_icon_pixbuf(context, icon, hot_x, hot_y);
-        g_object_unref(icon);
+        gtk_drag_set_icon_surface(context, icon);
+        cairo_surface_destroy(icon);
     }
 }
 
@@ -229,9 +218,30 @@ gboolean desperateOverview_ui_on_cell_button_press(GtkWidget *widget, GdkEventBu
         return FALSE;
 
     desperateOverview_ui_cancel_drag_hold_timer();
-    int wsid = resolve_workspace_id(data);
+    double lx, ly;
+    int wsid = locate_workspace(widget, data, event->x, event->y, &lx, &ly);
     gboolean bottom_view = (widget == g_current_preview);
-    WindowInfo *hit = hit_test_window_view(wsid, event->x, event->y, bottom_view);
+    if (wsid <= 0) {
+        g_drag.active_window = NULL;
+        g_drag.source_workspace = -1;
+        g_drag.pending_ws_click = FALSE;
+        g_drag.pending_window_click = FALSE;
+        g_drag.pending_ws_id = -1;
+        return TRUE;
+    }
+    WindowInfo *hit = hit_test_window_view(wsid, lx, ly, bottom_view);
+
+    if (hit && (event->state & GDK_CONTROL_MASK)) {
+        /* Ctrl+click picks windows for a multi-window drag. */
+        desperateOverview_ui_selection_toggle(hit);
+        desperateOverview_ui_queue_window_redraw(hit, TRUE, TRUE);
+        g_drag.active_window = NULL;
+        g_drag.source_workspace = -1;
+        g_drag.pending_ws_click = FALSE;
+        g_drag.pending_window_click = FALSE;
+        g_drag.pending_ws_id = -1;
+        return TRUE;
+    }
 
     if (hit) {
         g_drag.active_window = hit;
@@ -252,13 +262,13 @@ gboolean desperateOverview_ui_on_cell_button_press(GtkWidget *widget, GdkEventBu
 }
 
 gboolean desperateOverview_ui_on_cell_button_release(GtkWidget *widget, GdkEventButton *event, gpointer data) {
-    (void)widget;
     if (event->button != GDK_BUTTON_PRIMARY)
         return FALSE;
 
     desperateOverview_ui_cancel_drag_hold_timer();
 
-    int wsid = resolve_workspace_id(data);
+    double lx, ly;
+    int wsid = locate_workspace(widget, data, event->x, event->y, &lx, &ly);
     gboolean bottom_view = (widget == g_current_preview);
 
     if (!g_drag.in_progress &&
@@ -294,7 +304,7 @@ gboolean desperateOverview_ui_on_cell_button_release(GtkWidget *widget, GdkEvent
         g_drag.pending_window_click = FALSE;
         g_drag.pending_ws_id = -1;
         int idx = desperateOverview_ui_find_active_index(wsid);
-        close_overlay();
+        dismiss_overlay();
         if (idx >= 0)
                     desperateOverview_core_switch_workspace(desperateOverview_ui_workspace_display_name(g_active_list[idx]), wsid);
         return TRUE;
@@ -312,8 +322,9 @@ gboolean desperateOverview_ui_on_cell_button_release(GtkWidget *widget, GdkEvent
 }
 
 void desperateOverview_ui_on_cell_drag_begin(GtkWidget *widget, GdkDragContext *context, gpointer data) {
-    (void)widget;
-    int wsid = resolve_workspace_id(data);
+    /* The strip has no single workspace; the press already recorded which
+     * cell the drag starts from. */
+    int wsid = (widget == g_cell_strip) ? g_drag.source_workspace : resolve_workspace_id(data);
 
     desperateOverview_ui_cancel_drag_hold_timer();
 
@@ -327,7 +338,7 @@ void desperateOverview_ui_on_cell_drag_begin(GtkWidget *widget, GdkDragContext *
     g_drag.pending_window_click = FALSE;
     g_drag.pending_ws_id = -1;
     set_drag_icon_from_window(context, g_drag.active_window);
-    desperateOverview_ui_queue_cells_redraw();
+    desperateOverview_ui_drag_layer_update();
 }
 
 void desperateOverview_ui_on_cell_drag_end(GtkWidget *widget, GdkDragContext *context, gpointer data) {
@@ -339,7 +350,20 @@ void desperateOverview_ui_on_cell_drag_end(GtkWidget *widget, GdkDragContext *co
     g_drag.pending_ws_click = FALSE;
     g_drag.pending_window_click = FALSE;
     g_drag.pending_ws_id = -1;
-    desperateOverview_ui_queue_cells_redraw();
+    /* Only the drag layer changes here; a drop queues its own redraw for
+     * the move. */
+    desperateOverview_ui_drag_layer_update();
+}
+
+/* The dragged window, or the whole selection when it is part of one. */
+static int collect_drag_addrs(const char **addrs) {
+    WindowInfo *win = g_drag.active_window;
+    if (!win || !win->addr[0])
+        return 0;
+    if (desperateOverview_ui_selection_contains(win))
+        return desperateOverview_ui_selection_get(addrs, MAX_WINS_PER_WS);
+    addrs[0] = win->addr;
+    return 1;
 }
 
 void desperateOverview_ui_on_cell_drag_data_get(GtkWidget *widget,
@@ -350,16 +374,26 @@ void desperateOverview_ui_on_cell_drag_data_get(GtkWidget *widget,
                                                 gpointer data) {
     (void)widget; (void)context; (void)info; (void)time; (void)data;
 
-    if (!g_drag.active_window || !g_drag.active_window->addr[0])
+    const char *addrs[MAX_WINS_PER_WS];
+    int count = collect_drag_addrs(addrs);
+    if (count <= 0)
         return;
 
+    /* One address per line. */
+    GString *payload = g_string_new(NULL);
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            g_string_append_c(payload, '\n');
+        g_string_append(payload, addrs[i]);
+    }
     gtk_selection_data_set(
         selection_data,
         gdk_atom_intern_static_string(g_drag_target_name),
         8,
-        (const guchar *)g_drag.active_window->addr,
-        (gint)(strlen(g_drag.active_window->addr) + 1)
+        (const guchar *)payload->str,
+        (gint)(payload->len + 1)
     );
+    g_string_free(payload, TRUE);
 }
 
 void desperateOverview_ui_on_cell_drag_data_received(GtkWidget *widget,
@@ -370,10 +404,11 @@ void desperateOverview_ui_on_cell_drag_data_received(GtkWidget *widget,
                                                      guint info,
                                                      guint time,
                                                      gpointer data) {
-    (void)widget; (void)x; (void)y; (void)info;
+    (void)info;
 
     gboolean success = FALSE;
-    int target_ws = resolve_workspace_id(data);
+    double lx, ly;
+    int target_ws = locate_workspace(widget, data, x, y, &lx, &ly);
 
     if (target_ws > 0 && target_ws < MAX_WS &&
         selection_data &&
@@ -383,23 +418,31 @@ void desperateOverview_ui_on_cell_drag_data_received(GtkWidget *widget,
         gint len = gtk_selection_data_get_length(selection_data);
 
         if (payload && len > 0) {
-            char addr[64];
-            gint copy = len >= (gint)sizeof(addr) ? (gint)sizeof(addr) - 1 : len;
-            memcpy(addr, payload, (size_t)copy);
-            addr[copy] = '\0';
-
-            if (addr[0]) {
-                            desperateOverview_core_move_window(addr, target_ws);
+            gchar *text = g_strndup((const gchar *)payload, (gsize)len);
+            gchar **lines = g_strsplit(text, "\n", MAX_WINS_PER_WS);
+            const char *addrs[MAX_WINS_PER_WS];
+            int count = 0;
+            for (int i = 0; lines[i] && count < MAX_WINS_PER_WS; ++i) {
+                if (lines[i][0])
+                    addrs[count++] = lines[i];
+            }
+            if (count > 0) {
+                desperateOverview_ui_move_windows(addrs, count, target_ws);
+                if (count > 1)
+                    desperateOverview_ui_selection_clear();
                 success = TRUE;
             }
+            g_strfreev(lines);
+            g_free(text);
         }
     }
 
     gtk_drag_finish(context, success, FALSE, time);
 
+    /* The move already damaged the cells it touched. */
     if (success) {
+        start_drop_flash(target_ws);
         follow_drop_to_workspace(target_ws);
-        desperateOverview_ui_queue_cells_redraw();
     }
 }
 
@@ -473,8 +516,11 @@ gboolean desperateOverview_ui_on_new_ws_drag_drop(GtkWidget *widget, GdkDragCont
     }
 
     gtk_drag_finish(context, TRUE, FALSE, time);
-                desperateOverview_core_move_window(g_drag.active_window->addr, free_ws);
-    desperateOverview_ui_queue_cells_redraw();
+    const char *addrs[MAX_WINS_PER_WS];
+    int count = collect_drag_addrs(addrs);
+    desperateOverview_ui_move_windows(addrs, count, free_ws);
+    if (count > 1)
+        desperateOverview_ui_selection_clear();
     follow_drop_to_workspace(free_ws);
     return TRUE;
 }
@@ -482,7 +528,12 @@ gboolean desperateOverview_ui_on_new_ws_drag_drop(GtkWidget *widget, GdkDragCont
 gboolean desperateOverview_ui_on_key(GtkWidget *widget, GdkEventKey *event, gpointer data) {
     (void)widget; (void)data;
     if (event->keyval == GDK_KEY_Escape) {
-        close_overlay();
+        dismiss_overlay();
+        return TRUE;
+    }
+
+    if (event->keyval == GDK_KEY_F12) {
+        desperateOverview_ui_hud_toggle();
         return TRUE;
     }
 
@@ -511,7 +562,7 @@ gboolean desperateOverview_ui_on_key(GtkWidget *widget, GdkEventKey *event, gpoi
     if (event->keyval == GDK_KEY_Return || event->keyval == GDK_KEY_KP_Enter) {
         if (g_active_workspace > 0) {
             int idx = desperateOverview_ui_find_active_index(g_active_workspace);
-            close_overlay();
+            dismiss_overlay();
             if (idx >= 0)
                             desperateOverview_core_switch_workspace(desperateOverview_ui_workspace_display_name(g_active_list[idx]), g_active_workspace);
         }
@@ -0,0 +1,284 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_hud.h"
+
+#include <cairo.h>
+#include <glib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "desperateOverview_config.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_ui_drawing.h"
+#include "desperateOverview_ui_state.h"
+#include "desperateOverview_trace.h"
+
+#define HUD_MAX_LINES      48
+#define HUD_LINE_LEN       128
+#define HUD_MAX_WINDOWS    16
+#define HUD_FONT_SIZE      12.0
+#define HUD_LINE_HEIGHT    15.0
+#define HUD_PADDING        10.0
+#define HUD_MARGIN         16.0
+#define HUD_REFRESH_MS     250
+
+typedef struct {
+    char text[HUD_MAX_LINES][HUD_LINE_LEN];
+    int  count;
+} HudLines;
+
+typedef struct {
+    double x, y, w, h;
+} HudBox;
+
+static GtkWidget *g_hud_area = NULL;
+static guint      g_hud_timer_id = 0;
+static int        g_hud_enabled = -1;   /* -1 until read from the config */
+static gboolean   g_hud_last_box_valid = FALSE;
+static HudBox     g_hud_last_box;       /* panel drawn last, in area coords */
+
+static gboolean hud_enabled(void) {
+    if (g_hud_enabled < 0) {
+        const OverlayConfig *cfg = config_get();
+        g_hud_enabled = (cfg && cfg->hud_enabled) ? 1 : 0;
+    }
+    return g_hud_enabled == 1;
+}
+
+static void hud_add(HudLines *lines, const char *fmt, ...) G_GNUC_PRINTF(2, 3);
+
+static void hud_add(HudLines *lines, const char *fmt, ...) {
+    if (lines->count >= HUD_MAX_LINES)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    g_vsnprintf(lines->text[lines->count], HUD_LINE_LEN, fmt, ap);
+    va_end(ap);
+    lines->count++;
+}
+
+static double ms(uint64_t ns) {
+    return (double)ns / 1e6;
+}
+
+static void hud_add_stage(HudLines *lines, const char *label, DesperateOverviewMetric metric) {
+    DesperateOverviewMetricSummary s;
+    desperateOverview_metrics_get(metric, &s);
+    if (s.count == 0) {
+        hud_add(lines, "%-14s        -", label);
+        return;
+    }
+    hud_add(lines, "%-14s last %7.2f  p50 %7.2f  p99 %7.2f  max %7.2f ms",
+            label, ms(s.last_ns), ms(s.p50_ns), ms(s.p99_ns), ms(s.max_ns));
+}
+
+static void hud_collect(HudLines *lines) {
+    uint64_t now = desperateOverview_metrics_now_ns();
+
+    hud_add(lines, "desperateOverview HUD (F12)");
+    hud_add_stage(lines, "draw cell", DESPERATEOVERVIEW_METRIC_DRAW_CELL);
+    hud_add_stage(lines, "draw current", DESPERATEOVERVIEW_METRIC_DRAW_CURRENT);
+    hud_add_stage(lines, "preview scale", DESPERATEOVERVIEW_METRIC_PREVIEW_SCALE);
+    hud_add_stage(lines, "refresh", DESPERATEOVERVIEW_METRIC_REFRESH_TOTAL);
+    hud_add_stage(lines, "capture grab", DESPERATEOVERVIEW_METRIC_CAPTURE_GRAB);
+    hud_add_stage(lines, "thumb decode", DESPERATEOVERVIEW_METRIC_THUMB_DECODE);
+    hud_add_stage(lines, "event->frame", DESPERATEOVERVIEW_METRIC_EVENT_TO_FRAME);
+    hud_add_stage(lines, "show->frame", DESPERATEOVERVIEW_METRIC_SHOW_TO_FRAME);
+    hud_add_stage(lines, "anim frame", DESPERATEOVERVIEW_METRIC_ANIM_FRAME_INTERVAL);
+
+    uint64_t hits = desperateOverview_metrics_counter(DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_HIT);
+    uint64_t misses = desperateOverview_metrics_counter(DESPERATEOVERVIEW_COUNTER_THUMB_CACHE_MISS);
+    uint64_t lookups = hits + misses;
+    hud_add(lines, "thumb cache    %5.1f%% hit (%llu/%llu)   capture failures %llu",
+            lookups ? 100.0 * (double)hits / (double)lookups : 0.0,
+            (unsigned long long)hits, (unsigned long long)lookups,
+            (unsigned long long)desperateOverview_metrics_counter(DESPERATEOVERVIEW_COUNTER_CAPTURE_FAILED));
+
+    uint64_t surf_hits = desperateOverview_metrics_counter(DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_HIT);
+    uint64_t surf_lookups = surf_hits +
+        desperateOverview_metrics_counter(DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_MISS);
+    hud_add(lines, "surface cache  %5.1f%% hit (%llu/%llu)",
+            surf_lookups ? 100.0 * (double)surf_hits / (double)surf_lookups : 0.0,
+            (unsigned long long)surf_hits, (unsigned long long)surf_lookups);
+
+    int64_t last_refresh = desperateOverview_metrics_gauge(DESPERATEOVERVIEW_GAUGE_LAST_REFRESH_NS);
+    long long in_flight = (long long)desperateOverview_metrics_gauge(DESPERATEOVERVIEW_GAUGE_CAPTURES_IN_FLIGHT);
+    if (last_refresh > 0 && now > (uint64_t)last_refresh)
+        hud_add(lines, "in flight %lld   last refresh %.1f s ago",
+                in_flight, (double)(now - (uint64_t)last_refresh) / 1e9);
+    else
+        hud_add(lines, "in flight %lld   last refresh -", in_flight);
+
+    if (g_active_workspace <= 0 || g_active_workspace >= MAX_WS)
+        return;
+    WorkspaceWindows *W = &g_ws[g_active_workspace];
+    hud_add(lines, "workspace %s: %d windows   (age / capture)",
+            desperateOverview_ui_workspace_display_name(g_active_workspace), W->count);
+    for (int i = 0; i < W->count && i < HUD_MAX_WINDOWS; ++i) {
+        const WindowInfo *win = &W->wins[i];
+        const char *label = win->class_name && win->class_name[0] ? win->class_name : win->addr;
+        if (!win->capture_time_ns) {
+            hud_add(lines, "  %-20.20s   no capture", label);
+            continue;
+        }
+        double age = now > win->capture_time_ns ? (double)(now - win->capture_time_ns) / 1e9 : 0.0;
+        hud_add(lines, "  %-20.20s %6.1f s  %7.2f ms%s", label, age,
+                ms(win->capture_latency_ns), win->live_pixbuf ? "  live" : "");
+    }
+    if (W->count > HUD_MAX_WINDOWS)
+        hud_add(lines, "  ... %d more", W->count - HUD_MAX_WINDOWS);
+}
+
+/* Panel size and position for `lines`, anchored to the top-right corner.
+ * `cr` must already have the HUD font selected. */
+static void hud_layout(cairo_t *cr, const HudLines *lines, double width, HudBox *box) {
+    double text_w = 0.0;
+    for (int i = 0; i < lines->count; ++i) {
+        cairo_text_extents_t ext;
+        cairo_text_extents(cr, lines->text[i], &ext);
+        if (ext.x_advance > text_w)
+            text_w = ext.x_advance;
+    }
+
+    box->w = text_w + 2.0 * HUD_PADDING;
+    box->h = lines->count * HUD_LINE_HEIGHT + 2.0 * HUD_PADDING;
+    box->x = width - box->w - HUD_MARGIN;
+    box->y = HUD_MARGIN;
+    if (box->x < 0.0)
+        box->x = 0.0;
+}
+
+static void hud_select_font(cairo_t *cr) {
+    cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, HUD_FONT_SIZE);
+}
+
+void desperateOverview_ui_hud_render(cairo_t *cr, double width, double height) {
+    if (!cr || width <= 0 || height <= 0)
+        return;
+
+    HudLines lines;
+    lines.count = 0;
+    hud_collect(&lines);
+
+    cairo_save(cr);
+    hud_select_font(cr);
+    HudBox box;
+    hud_layout(cr, &lines, width, &box);
+    g_hud_last_box = box;
+    g_hud_last_box_valid = TRUE;
+
+    cairo_add_rounded_rect(cr, box.x, box.y, box.w, box.h, 6.0);
+    cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.75);
+    cairo_fill(cr);
+
+    for (int i = 0; i < lines.count; ++i) {
+        if (i == 0)
+            cairo_set_source_rgba(cr, 1.0, 0.8, 0.2, 1.0);
+        else
+            cairo_set_source_rgba(cr, 0.9, 0.95, 0.9, 1.0);
+        cairo_move_to(cr, box.x + HUD_PADDING,
+                      box.y + HUD_PADDING + (i + 1) * HUD_LINE_HEIGHT - 3.0);
+        cairo_show_text(cr, lines.text[i]);
+    }
+    cairo_restore(cr);
+}
+
+static gboolean hud_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
+    (void)data;
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(widget, &alloc);
+    uint64_t span = desperateOverview_trace_begin();
+    desperateOverview_ui_hud_render(cr, alloc.width, alloc.height);
+    desperateOverview_trace_end("hud_draw", span, NULL);
+    return FALSE;
+}
+
+static void hud_queue_box(const HudBox *box) {
+    int x0 = (int)floor(box->x);
+    int y0 = (int)floor(box->y);
+    gtk_widget_queue_draw_area(g_hud_area, x0, y0,
+                               (int)ceil(box->x + box->w) - x0,
+                               (int)ceil(box->y + box->h) - y0);
+}
+
+/* Ages and in-flight counts change without any redraw of the overlay. Only
+ * the panel is damaged: the area spans the whole monitor, and repainting it
+ * four times a second would skew the frame times the HUD reports. The panel
+ * resizes with its text, so the old and new extents are both queued. */
+static gboolean hud_tick(gpointer data) {
+    (void)data;
+    if (!g_hud_area) {
+        g_hud_timer_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+    if (!g_hud_last_box_valid) {
+        gtk_widget_queue_draw(g_hud_area);
+        return G_SOURCE_CONTINUE;
+    }
+
+    HudLines lines;
+    lines.count = 0;
+    hud_collect(&lines);
+    cairo_surface_t *scratch = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+    cairo_t *cr = cairo_create(scratch);
+    hud_select_font(cr);
+    HudBox next;
+    hud_layout(cr, &lines, gtk_widget_get_allocated_width(g_hud_area), &next);
+    cairo_destroy(cr);
+    cairo_surface_destroy(scratch);
+
+    hud_queue_box(&g_hud_last_box);
+    if (next.x != g_hud_last_box.x || next.w != g_hud_last_box.w || next.h != g_hud_last_box.h)
+        hud_queue_box(&next);
+    return G_SOURCE_CONTINUE;
+}
+
+static void hud_sync_visibility(void) {
+    if (!g_hud_area)
+        return;
+    gboolean on = hud_enabled();
+    g_hud_last_box_valid = FALSE;
+    gtk_widget_set_visible(g_hud_area, on);
+    if (on && !g_hud_timer_id)
+        g_hud_timer_id = g_timeout_add(HUD_REFRESH_MS, hud_tick, NULL);
+    else if (!on && g_hud_timer_id) {
+        g_source_remove(g_hud_timer_id);
+        g_hud_timer_id = 0;
+    }
+}
+
+void desperateOverview_ui_hud_attach(GtkWidget *root_overlay) {
+    if (!root_overlay)
+        return;
+    desperateOverview_ui_hud_detach();
+
+    GtkWidget *area = gtk_drawing_area_new();
+    gtk_widget_set_hexpand(area, TRUE);
+    gtk_widget_set_vexpand(area, TRUE);
+    gtk_widget_set_no_show_all(area, TRUE);
+    g_signal_connect(area, "draw", G_CALLBACK(hud_draw), NULL);
+    gtk_overlay_add_overlay(GTK_OVERLAY(root_overlay), area);
+    gtk_overlay_set_overlay_pass_through(GTK_OVERLAY(root_overlay), area, TRUE);
+    g_hud_area = area;
+    hud_sync_visibility();
+}
+
+void desperateOverview_ui_hud_detach(void) {
+    if (g_hud_timer_id) {
+        g_source_remove(g_hud_timer_id);
+        g_hud_timer_id = 0;
+    }
+    g_hud_area = NULL;
+    g_hud_last_box_valid = FALSE;
+}
+
+void desperateOverview_ui_hud_toggle(void) {
+    g_hud_enabled = hud_enabled() ? 0 : 1;
+    hud_sync_visibility();
+}
+
+gboolean desperateOverview_ui_hud_visible(void) {
+    return g_hud_area && hud_enabled();
+}
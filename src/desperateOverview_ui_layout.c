@@ -3,25 +3,89 @@
 #include "desperateOverview_ui_layout.h"
 
 #include <gtk/gtk.h>
+#include <math.h>
 
+#include "desperateOverview_capture_backend.h"
 #include "desperateOverview_config.h"
+#include "desperateOverview_geometry.h"
 #include "desperateOverview_ui_state.h"
 #include "desperateOverview_ui_render.h"
 #include "desperateOverview_ui_drawing.h"
 #include "desperateOverview_ui_events.h"
 #include "desperateOverview_ui_drag.h"
+#include "desperateOverview_ui_strip.h"
+#include "desperateOverview_trace.h"
 
 static const double G_OVERLAY_FRACTION = 0.33;
 static const double G_PREVIEW_FRACTION = 0.85;
 static const double G_GAP_PX           = 20.0;
+static const double G_GHOST_RATIO      = 0.35;
+static const double G_GRID_FRACTION    = 0.5;   /* max monitor height for the grid */
 
 static void clear_root_box_children(void);
 static gboolean draw_new_workspace_target(GtkWidget *widget, cairo_t *cr, gpointer data);
 
-void desperateOverview_ui_build_overlay_content(GtkWidget *root_box) {
-    if (!root_box)
-        return;
+typedef struct {
+    double overlay_h;
+    double cell_w;
+    double cell_h;
+    double gap;
+    int    ghost_w;
+    double viewport_w;  /* > 0 in scroll mode: visible width of the strip */
+    int    columns;     /* 0 lays all cells out in one row */
+} CellMetrics;
+
+/* Largest cell for `count` cells in `columns` columns within avail_w x
+ * avail_h, never larger than the single-row base cell. */
+static double grid_cell_width(int count, int columns, double avail_w, double avail_h,
+                              double base_w, double gap) {
+    int rows = (count + columns - 1) / columns;
+    double by_width = (avail_w - gap * columns) / (columns + G_GHOST_RATIO);
+    double by_height = (avail_h - gap * (rows - 1)) / rows * g_aspect_ratio;
+    return fmin(base_w, fmin(by_width, by_height));
+}
+
+/* Grid mode: grid_columns columns, or with 0 the column count that gives
+ * the largest cells, using up to G_GRID_FRACTION of the monitor height. */
+static void compute_grid_metrics(int count, int base_w_px, int base_h_px,
+                                 double base_w, CellMetrics *out) {
+    const OverlayConfig *cfg = config_get();
+    double gap = G_GAP_PX;
+    double avail_w = (double)base_w_px;
+    double avail_h = (double)base_h_px * G_GRID_FRACTION * G_PREVIEW_FRACTION;
+
+    int columns = (cfg && cfg->grid_columns > 0) ? (int)cfg->grid_columns : 0;
+    if (columns > count)
+        columns = count;
+    double cell_w = 0.0;
+    if (columns > 0) {
+        cell_w = grid_cell_width(count, columns, avail_w, avail_h, base_w, gap);
+    } else {
+        for (int c = 1; c <= count; ++c) {
+            double w = grid_cell_width(count, c, avail_w, avail_h, base_w, gap);
+            if (w >= cell_w) {
+                cell_w = w;
+                columns = c;
+            }
+        }
+    }
+    if (cell_w < 10.0)
+        cell_w = 10.0;
 
+    int rows = (count + columns - 1) / columns;
+    out->cell_w = cell_w;
+    out->cell_h = cell_w / g_aspect_ratio;
+    out->gap = gap;
+    out->ghost_w = (int)(cell_w * G_GHOST_RATIO + 0.5);
+    out->viewport_w = 0.0;
+    out->columns = columns;
+    out->overlay_h = (rows * out->cell_h + (rows - 1) * gap) / G_PREVIEW_FRACTION;
+}
+
+/* Cells shrink together once `count` of them plus the new-workspace
+ * target no longer fit the monitor width. In scroll mode they stop at
+ * min_cell_width and the strip scrolls instead. */
+static void compute_cell_metrics(int count, CellMetrics *out) {
     int base_w_px = desperateOverview_ui_get_effective_mon_width();
     int base_h_px = desperateOverview_ui_get_effective_mon_height();
     if (base_w_px <= 0) base_w_px = (g_mon_width > 0) ? g_mon_width : 1920;
@@ -30,17 +94,124 @@ void desperateOverview_ui_build_overlay_content(GtkWidget *root_box) {
     double overlay_h = (double)base_h_px * G_OVERLAY_FRACTION;
     double base_h    = overlay_h * G_PREVIEW_FRACTION;
     double base_w    = base_h * g_aspect_ratio;
-    int count = g_active_count > 0 ? g_active_count : 1;
+    if (count <= 0)
+        count = 1;
+    const OverlayConfig *cfg = config_get();
+    if (cfg && cfg->strip_mode == OVERLAY_STRIP_GRID) {
+        compute_grid_metrics(count, base_w_px, base_h_px, base_w, out);
+        return;
+    }
+
     double gap = G_GAP_PX;
     double avail_for_cells = (double)base_w_px - gap * (count - 1);
     if (avail_for_cells < 10.0) avail_for_cells = 10.0;
-    const double ghost_ratio = 0.35;
-    double total_cells_width = base_w * (count + ghost_ratio);
+    double total_cells_width = base_w * (count + G_GHOST_RATIO);
     double scale = 1.0;
     if (total_cells_width > avail_for_cells)
         scale = avail_for_cells / total_cells_width;
-    double cell_w = base_w * scale;
-    double cell_h = base_h * scale;
+
+    gboolean scroll = cfg && cfg->strip_mode == OVERLAY_STRIP_SCROLL;
+    if (scroll && base_w * scale < cfg->min_cell_width)
+        scale = fmin(1.0, (double)cfg->min_cell_width / base_w);
+
+    out->overlay_h = overlay_h;
+    out->cell_w = base_w * scale;
+    out->cell_h = base_h * scale;
+    out->gap = gap;
+    out->ghost_w = (int)(out->cell_w * G_GHOST_RATIO + 0.5);
+    out->viewport_w = 0.0;
+    out->columns = 0;
+    if (scroll) {
+        double strip_w = count * out->cell_w + (count - 1) * gap;
+        double room = (double)base_w_px - out->ghost_w - 2.0 * gap;
+        out->viewport_w = fmax(out->cell_w, fmin(strip_w, room));
+    }
+}
+
+/* Width of the current-workspace frame: from its allocation once it has
+ * one, otherwise from the room left under the strip. */
+static double current_preview_frame_width(const CellMetrics *m) {
+    int eff_w = desperateOverview_ui_get_effective_mon_width();
+    int eff_h = desperateOverview_ui_get_effective_mon_height();
+    if (eff_w <= 0) eff_w = (g_mon_width > 0) ? g_mon_width : 1920;
+    if (eff_h <= 0) eff_h = (g_mon_height > 0) ? g_mon_height : 1080;
+
+    if (g_current_preview) {
+        GtkAllocation alloc;
+        gtk_widget_get_allocation(g_current_preview, &alloc);
+        if (alloc.width > 1 && alloc.height > 1) {
+            OverviewPreviewTransform t;
+            desperateOverview_geometry_compute_preview_transform(eff_w, eff_h, alloc.width,
+                                                                 alloc.height, &t);
+            return t.view_w;
+        }
+    }
+    return fmin((double)eff_w, ((double)eff_h - m->overlay_h) * g_aspect_ratio);
+}
+
+/* Device pixels per layout pixel on the overlay's monitor; the overlay
+ * window may not exist yet when the first capture is primed. */
+static int monitor_scale_factor(void) {
+    GdkDisplay *display = g_overlay_window ? gtk_widget_get_display(g_overlay_window)
+                                           : gdk_display_get_default();
+    GdkMonitor *monitor = desperateOverview_ui_match_monitor(display);
+    int scale = monitor ? gdk_monitor_get_scale_factor(monitor) : 1;
+    return scale > 0 ? scale : 1;
+}
+
+/* Thumbnails are drawn in the strip cells and, before a live frame arrives,
+ * in the current-workspace preview; a window filling its workspace spans the
+ * wider of the two, so capture that many device pixels. */
+static void apply_thumbnail_width(const CellMetrics *m) {
+    double width = fmax(m->cell_w, current_preview_frame_width(m));
+    desperateOverview_capture_set_thumbnail_width((uint32_t)ceil(width * monitor_scale_factor()));
+}
+
+static void on_current_preview_allocate(GtkWidget *widget, GdkRectangle *alloc, gpointer data) {
+    (void)widget;
+    (void)alloc;
+    (void)data;
+    CellMetrics m;
+    compute_cell_metrics(g_active_count, &m);
+    apply_thumbnail_width(&m);
+}
+
+static void size_scroller(const CellMetrics *m) {
+    GtkWidget *scroller = g_cell_strip ? gtk_widget_get_ancestor(g_cell_strip, GTK_TYPE_SCROLLED_WINDOW) : NULL;
+    if (scroller && m->viewport_w > 0.0)
+        gtk_widget_set_size_request(scroller, (int)ceil(m->viewport_w), (int)(m->cell_h + 0.5));
+}
+
+void desperateOverview_ui_layout_prime_capture(void) {
+    const OverlayConfig *cfg = config_get();
+    CellMetrics m;
+    compute_cell_metrics(g_active_count, &m);
+    apply_thumbnail_width(&m);
+    if (!cfg || cfg->strip_mode != OVERLAY_STRIP_SCROLL) {
+        desperateOverview_ui_strip_capture_all();
+        return;
+    }
+    /* The strip opens scrolled to the active workspace; capture that stretch
+     * before the first refresh so opening never waits on every workspace. */
+    int visible = (int)ceil(m.viewport_w / (m.cell_w + m.gap));
+    int center = desperateOverview_ui_find_active_index(g_active_workspace);
+    if (center < 0)
+        center = 0;
+    int first = center - visible;
+    int last = center + visible;
+    desperateOverview_ui_strip_capture_range(first, last);
+}
+
+void desperateOverview_ui_build_overlay_content(GtkWidget *root_box) {
+    if (!root_box)
+        return;
+
+    CellMetrics m;
+    compute_cell_metrics(g_active_count, &m);
+    double overlay_h = m.overlay_h;
+    double cell_w = m.cell_w;
+    double cell_h = m.cell_h;
+    double gap = m.gap;
 
     GtkWidget *frame = gtk_event_box_new();
     gtk_widget_set_hexpand(frame, TRUE);
@@ -62,6 +233,8 @@ void desperateOverview_ui_build_overlay_content(GtkWidget *root_box) {
     gtk_widget_set_valign(current_preview, GTK_ALIGN_FILL);
     g_signal_connect(current_preview, "draw",
                      G_CALLBACK(desperateOverview_ui_draw_current_workspace), NULL);
+    g_signal_connect(current_preview, "size-allocate",
+                     G_CALLBACK(on_current_preview_allocate), NULL);
     gtk_widget_add_events(current_preview,
                           GDK_BUTTON_PRESS_MASK |
                           GDK_BUTTON_RELEASE_MASK |
@@ -111,58 +284,24 @@ void desperateOverview_ui_build_overlay_content(GtkWidget *root_box) {
     gtk_style_context_add_class(gtk_widget_get_style_context(g_status_label), "desperateOverview-status");
     gtk_box_pack_start(GTK_BOX(status_box), g_status_label, TRUE, TRUE, 0);
 
-    for (int i = 0; i < g_active_count; ++i) {
-        int wsid = g_active_list[i];
-        GtkWidget *cell = gtk_drawing_area_new();
-        g_cells[i] = cell;
-        gtk_widget_set_size_request(cell,
-                                    (int)(cell_w + 0.5),
-                                    (int)(cell_h + 0.5));
-        g_signal_connect(cell, "draw", G_CALLBACK(desperateOverview_ui_draw_cell),
-                         GINT_TO_POINTER(wsid));
-        gtk_widget_add_events(cell,
-                              GDK_BUTTON_PRESS_MASK |
-                              GDK_BUTTON_RELEASE_MASK |
-                              GDK_POINTER_MOTION_MASK |
-                              GDK_BUTTON_MOTION_MASK |
-                              GDK_LEAVE_NOTIFY_MASK);
-        g_signal_connect(cell, "motion-notify-event",
-                         G_CALLBACK(desperateOverview_ui_on_cell_motion), GINT_TO_POINTER(wsid));
-        g_signal_connect(cell, "leave-notify-event",
-                         G_CALLBACK(desperateOverview_ui_on_cell_leave), GINT_TO_POINTER(wsid));
-        g_signal_connect(cell, "button-press-event",
-                         G_CALLBACK(desperateOverview_ui_on_cell_button_press), GINT_TO_POINTER(wsid));
-        g_signal_connect(cell, "button-release-event",
-                         G_CALLBACK(desperateOverview_ui_on_cell_button_release), GINT_TO_POINTER(wsid));
-        gtk_drag_source_set(cell,
-                            GDK_BUTTON1_MASK,
-                            g_drag_targets,
-                            g_drag_targets_count,
-                            GDK_ACTION_MOVE);
-        g_signal_connect(cell, "drag-begin",
-                         G_CALLBACK(desperateOverview_ui_on_cell_drag_begin), GINT_TO_POINTER(wsid));
-        g_signal_connect(cell, "drag-end",
-                         G_CALLBACK(desperateOverview_ui_on_cell_drag_end), GINT_TO_POINTER(wsid));
-        g_signal_connect(cell, "drag-data-get",
-                         G_CALLBACK(desperateOverview_ui_on_cell_drag_data_get), GINT_TO_POINTER(wsid));
-        gtk_drag_dest_set(cell,
-                          GTK_DEST_DEFAULT_MOTION |
-                          GTK_DEST_DEFAULT_HIGHLIGHT |
-                          GTK_DEST_DEFAULT_DROP,
-                          g_drag_targets,
-                          g_drag_targets_count,
-                          GDK_ACTION_MOVE);
-        g_signal_connect(cell, "drag-drop",
-                         G_CALLBACK(desperateOverview_ui_on_cell_drag_drop), GINT_TO_POINTER(wsid));
-        g_signal_connect(cell, "drag-data-received",
-                         G_CALLBACK(desperateOverview_ui_on_cell_drag_data_received), GINT_TO_POINTER(wsid));
-        gtk_box_pack_start(GTK_BOX(hbox), cell, FALSE, FALSE, 0);
+    g_cell_strip = desperateOverview_ui_strip_new();
+    desperateOverview_ui_strip_set_layout(cell_w, cell_h, gap, m.columns);
+    if (m.viewport_w > 0.0) {
+        GtkWidget *scroller = gtk_scrolled_window_new(NULL, NULL);
+        gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scroller),
+                                       GTK_POLICY_AUTOMATIC, GTK_POLICY_NEVER);
+        gtk_scrolled_window_set_overlay_scrolling(GTK_SCROLLED_WINDOW(scroller), TRUE);
+        gtk_container_add(GTK_CONTAINER(scroller), g_cell_strip);
+        gtk_box_pack_start(GTK_BOX(hbox), scroller, FALSE, FALSE, 0);
+        size_scroller(&m);
+        desperateOverview_ui_strip_attach_scroller(scroller);
+    } else {
+        gtk_box_pack_start(GTK_BOX(hbox), g_cell_strip, FALSE, FALSE, 0);
     }
 
     GtkWidget *ghost = gtk_drawing_area_new();
     g_new_ws_target = ghost;
-    int ghost_width = (int)(cell_w * ghost_ratio + 0.5);
-    gtk_widget_set_size_request(ghost, ghost_width, (int)(cell_h));
+    gtk_widget_set_size_request(ghost, m.ghost_w, (int)(cell_h));
     gtk_widget_set_hexpand(ghost, FALSE);
     gtk_widget_set_margin_start(ghost, (int)(gap * 0.5));
     gtk_style_context_add_class(gtk_widget_get_style_context(ghost), "desperateOverview-ghost");
@@ -183,17 +322,9 @@ void desperateOverview_ui_build_overlay_content(GtkWidget *root_box) {
     g_signal_connect(ghost, "drag-drop",
                      G_CALLBACK(desperateOverview_ui_on_new_ws_drag_drop), NULL);
     gtk_widget_queue_draw(ghost);
-
-    for (int j = g_active_count; j < MAX_WS; ++j)
-        g_cells[j] = NULL;
 }
 
-void desperateOverview_ui_rebuild_overlay_content(void) {
-    if (!g_overlay_window || !g_root_box)
-        return;
-    clear_root_box_children();
-    desperateOverview_ui_build_overlay_content(g_root_box);
-    gtk_widget_show_all(g_overlay_window);
+static void remember_built_layout(void) {
     g_built_active_count = g_active_count;
     memcpy(g_built_active_list, g_active_list, sizeof(g_active_list));
     for (int i = 0; i < g_active_count && i < MAX_WS; ++i) {
@@ -203,6 +334,40 @@ void desperateOverview_ui_rebuild_overlay_content(void) {
     }
 }
 
+/* The strip draws whatever g_active_list holds, so a changed workspace
+ * list only resizes it and the new-workspace target; no widget is created
+ * or destroyed. Names are not drawn by cells, so a rename only updates the
+ * remembered layout. */
+static void resize_strip(void) {
+    CellMetrics m;
+    compute_cell_metrics(g_active_count, &m);
+    desperateOverview_ui_strip_set_layout(m.cell_w, m.cell_h, m.gap, m.columns);
+    size_scroller(&m);
+    apply_thumbnail_width(&m);
+    GtkWidget *frame = g_overlay_content ? gtk_widget_get_parent(g_overlay_content) : NULL;
+    if (frame)
+        gtk_widget_set_size_request(frame, -1, (int)(m.overlay_h));
+    if (g_new_ws_target)
+        gtk_widget_set_size_request(g_new_ws_target, m.ghost_w, (int)(m.cell_h));
+}
+
+void desperateOverview_ui_rebuild_overlay_content(void) {
+    if (!g_overlay_window || !g_root_box)
+        return;
+    uint64_t span = desperateOverview_trace_begin();
+    if (g_overlay_content && g_cell_strip) {
+        resize_strip();
+        if (g_current_preview)
+            gtk_widget_queue_draw(g_current_preview);
+    } else {
+        clear_root_box_children();
+        desperateOverview_ui_build_overlay_content(g_root_box);
+        gtk_widget_show_all(g_overlay_window);
+    }
+    remember_built_layout();
+    desperateOverview_trace_end("overlay_update", span, NULL);
+}
+
 static void clear_root_box_children(void) {
     if (!g_root_box)
         return;
@@ -215,12 +380,12 @@ static void clear_root_box_children(void) {
     g_current_preview = NULL;
     g_status_label = NULL;
     g_new_ws_target = NULL;
-    for (int i = 0; i < MAX_WS; ++i)
-        g_cells[i] = NULL;
+    g_cell_strip = NULL;
 }
 
 static gboolean draw_new_workspace_target(GtkWidget *widget, cairo_t *cr, gpointer data) {
     (void)data;
+    uint64_t span = desperateOverview_trace_begin();
     GtkAllocation alloc;
     gtk_widget_get_allocation(widget, &alloc);
     double x = 2.0;
@@ -251,6 +416,7 @@ static gboolean draw_new_workspace_target(GtkWidget *widget, cairo_t *cr, gpoint
     cairo_stroke(cr);
 
     cairo_restore(cr);
+    desperateOverview_trace_end("draw_new_workspace_target", span, NULL);
     return FALSE;
 }
 
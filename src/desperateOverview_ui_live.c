@@ -7,6 +7,8 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include "desperateOverview_core.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
 #include "desperateOverview_thumbnail_capture.h"
 
 typedef struct {
@@ -14,6 +16,8 @@ typedef struct {
     GdkPixbuf  *pixbuf;
     char        addr_snapshot[64];
     guint64     cookie_snapshot;
+    guint64     capture_time_ns;
+    guint64     capture_latency_ns;
 } LivePreviewTask;
 
 static DesperateOverviewLiveApply g_live_apply_cb = NULL;
@@ -33,6 +37,10 @@ static gboolean dispatch_live_preview(gpointer data) {
         strcmp(task->win->addr, task->addr_snapshot) == 0 &&
         task->cookie_snapshot == task->win->live_cookie &&
         g_live_apply_cb) {
+        if (task->pixbuf) {
+            task->win->capture_time_ns = task->capture_time_ns;
+            task->win->capture_latency_ns = task->capture_latency_ns;
+        }
         g_live_apply_cb(task->win, task->pixbuf, g_live_apply_data);
     } else if (task->pixbuf) {
         g_object_unref(task->pixbuf);
@@ -52,7 +60,11 @@ static void desperateOverview_ui_capture_live_preview(WindowInfo *win) {
 
     guint64 cookie = win->live_cookie;
 
+    uint64_t span = desperateOverview_trace_begin();
+    uint64_t capture_start = desperateOverview_metrics_now_ns();
     char *b64 = desperateOverview_core_capture_window_raw(win->addr);
+    uint64_t capture_end = desperateOverview_metrics_now_ns();
+    desperateOverview_trace_end("live_capture", span, win->addr);
     if (!b64) {
         g_warning("[desperateOverview] live preview capture failed for %s (no data)", win->addr);
         return;
@@ -73,6 +85,7 @@ static void desperateOverview_ui_capture_live_preview(WindowInfo *win) {
         return;
     }
 
+    uint64_t decode_start = desperateOverview_metrics_now_ns();
     GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
     gboolean ok = gdk_pixbuf_loader_write(loader, raw, raw_len, NULL);
     if (ok)
@@ -92,6 +105,7 @@ static void desperateOverview_ui_capture_live_preview(WindowInfo *win) {
 
     g_object_unref(loader);
     g_free(raw);
+    desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_LIVE_DECODE, decode_start);
 
     if (cookie != win->live_cookie) {
         if (result)
@@ -105,6 +119,8 @@ static void desperateOverview_ui_capture_live_preview(WindowInfo *win) {
         task->pixbuf = result;
         g_strlcpy(task->addr_snapshot, win->addr, sizeof(task->addr_snapshot));
         task->cookie_snapshot = cookie;
+        task->capture_time_ns = capture_end;
+        task->capture_latency_ns = capture_end - capture_start;
         g_idle_add(dispatch_live_preview, task);
     } else if (result) {
         g_object_unref(result);
@@ -0,0 +1,312 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_moves.h"
+
+#include <glib.h>
+#include <string.h>
+
+#include "desperateOverview_core.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
+#include "desperateOverview_ui_events.h"
+#include "desperateOverview_ui_preview_layout.h"
+#include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_strip.h"
+
+/* Room for two full batches in flight at once. */
+#define MAX_PENDING_MOVES (2 * MAX_WINS_PER_WS)
+G_STATIC_ASSERT(MAX_PENDING_MOVES >= MAX_WINS_PER_WS);
+
+/* A move the compositor accepted but has not confirmed through a refresh
+ * gives way to the core state after this long. */
+static const uint64_t G_MOVE_SETTLE_NS = 2000ull * 1000 * 1000;
+
+/* `in_flight` stays set until the dispatch of its batch is answered; only
+ * answered moves time out or are evicted to make room. */
+typedef struct {
+    char     addr[64];
+    int      source_ws;
+    int      target_ws;
+    uint64_t settle_from_ns;   /* dispatch time, then answer time */
+    guint    batch;
+    gboolean in_flight;
+} PendingMove;
+
+typedef struct {
+    char     addrs[MAX_WINS_PER_WS][64];
+    int      count;
+    int      wsid;
+    guint    batch;
+    gboolean ok;
+} MoveResult;
+
+/* GTK thread only. */
+static PendingMove g_pending_moves[MAX_PENDING_MOVES];
+static int         g_pending_count = 0;
+static guint       g_next_batch = 1;
+static char        g_selection[MAX_WINS_PER_WS][64];
+static int         g_selection_count = 0;
+
+static gboolean find_window(const char *addr, int *wsid_out, int *index_out) {
+    for (int wsid = 1; wsid < MAX_WS; ++wsid) {
+        const WorkspaceWindows *W = &g_ws[wsid];
+        for (int i = 0; i < W->count; ++i) {
+            if (strcmp(W->wins[i].addr, addr) == 0) {
+                *wsid_out = wsid;
+                *index_out = i;
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+static gboolean workspace_listed(int wsid) {
+    return desperateOverview_ui_find_active_index(wsid) >= 0;
+}
+
+/* Moves the window, pixbufs and all, to the end of the target's list.
+ * Live tasks of shifted slots see a different cookie and drop their frame. */
+static gboolean relocate_window(int source_ws, int index, int target_ws) {
+    WorkspaceWindows *src = &g_ws[source_ws];
+    WorkspaceWindows *dst = &g_ws[target_ws];
+    if (dst->count >= MAX_WINS_PER_WS)
+        return FALSE;
+
+    WindowInfo moved = src->wins[index];
+    memmove(&src->wins[index], &src->wins[index + 1],
+            sizeof(WindowInfo) * (size_t)(src->count - index - 1));
+    src->count--;
+    memset(&src->wins[src->count], 0, sizeof(WindowInfo));
+
+    moved.top_preview_valid = FALSE;
+    moved.bottom_preview_valid = FALSE;
+    dst->wins[dst->count++] = moved;
+    return TRUE;
+}
+
+/* WindowInfo pointers into the touched workspaces moved; drop the ones
+ * the interaction state holds and repaint those cells once. */
+static void queue_move_redraw(const gboolean touched[MAX_WS]) {
+    desperateOverview_ui_set_hover_window(NULL, FALSE);
+    g_drag.active_window = NULL;
+    desperateOverview_ui_preview_layout_invalidate();
+    if (!g_overlay_visible)
+        return;
+    for (int wsid = 1; wsid < MAX_WS; ++wsid) {
+        if (touched[wsid])
+            desperateOverview_ui_strip_queue_cell(wsid);
+    }
+    if (g_current_preview && g_active_workspace > 0 && g_active_workspace < MAX_WS &&
+        touched[g_active_workspace])
+        gtk_widget_queue_draw(g_current_preview);
+}
+
+static int find_pending(const char *addr, guint batch) {
+    for (int i = 0; i < g_pending_count; ++i) {
+        if (g_pending_moves[i].batch == batch &&
+            strcmp(g_pending_moves[i].addr, addr) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void drop_pending(int index) {
+    memmove(&g_pending_moves[index], &g_pending_moves[index + 1],
+            sizeof(PendingMove) * (size_t)(g_pending_count - index - 1));
+    g_pending_count--;
+}
+
+/* Frees a slot if the table is full by evicting the oldest answered move,
+ * which only waits for the snapshot to agree. False when every entry still
+ * belongs to a dispatch in flight. */
+static gboolean reserve_pending(void) {
+    if (g_pending_count < MAX_PENDING_MOVES)
+        return TRUE;
+    for (int i = 0; i < g_pending_count; ++i) {
+        if (!g_pending_moves[i].in_flight) {
+            drop_pending(i);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static gboolean move_done_idle(gpointer data) {
+    MoveResult *res = data;
+    gboolean touched[MAX_WS] = { FALSE };
+    gboolean rolled_back = FALSE;
+    for (int i = 0; i < res->count; ++i) {
+        int slot = find_pending(res->addrs[i], res->batch);
+        if (slot < 0)
+            continue;
+        if (res->ok) {
+            g_pending_moves[slot].in_flight = FALSE;
+            g_pending_moves[slot].settle_from_ns = desperateOverview_metrics_now_ns();
+            continue;
+        }
+        PendingMove move = g_pending_moves[slot];
+        drop_pending(slot);
+        int wsid, index;
+        if (find_window(move.addr, &wsid, &index) && wsid == move.target_ws &&
+            relocate_window(wsid, index, move.source_ws)) {
+            touched[move.source_ws] = TRUE;
+            touched[move.target_ws] = TRUE;
+        }
+        rolled_back = TRUE;
+    }
+    if (rolled_back)
+        queue_move_redraw(touched);
+    /* Moves without a pending entry (new-workspace drops, a full table)
+     * have nothing to roll back; the refresh still corrects the UI. */
+    if (!res->ok) {
+        g_warning("desperateOverview: moving %d window(s) to workspace %d failed%s",
+                  res->count, res->wsid, rolled_back ? ", rolled back" : "");
+        desperateOverview_core_request_refresh_async();
+    }
+    g_free(res);
+    return G_SOURCE_REMOVE;
+}
+
+/* Dispatch thread; the result is applied on the GTK thread. */
+static void move_done(const char *const *addrs, int count, int wsid, bool ok, void *user_data) {
+    MoveResult *res = g_new0(MoveResult, 1);
+    res->batch = GPOINTER_TO_UINT(user_data);
+    for (int i = 0; i < count && i < MAX_WINS_PER_WS; ++i)
+        g_strlcpy(res->addrs[res->count++], addrs[i], sizeof(res->addrs[0]));
+    res->wsid = wsid;
+    res->ok = ok;
+    g_idle_add(move_done_idle, res);
+}
+
+void desperateOverview_ui_move_windows(const char *const *addrs, int count, int target_ws) {
+    if (!addrs || count <= 0 || target_ws <= 0 || target_ws >= MAX_WS)
+        return;
+    if (count > MAX_WINS_PER_WS)
+        count = MAX_WINS_PER_WS;
+    /* The addresses may point into g_ws, which the moves rearrange. */
+    char copies[MAX_WINS_PER_WS][64];
+    const char *list[MAX_WINS_PER_WS];
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!addrs[i] || !addrs[i][0])
+            continue;
+        g_strlcpy(copies[n], addrs[i], sizeof(copies[n]));
+        list[n] = copies[n];
+        ++n;
+    }
+    if (n == 0)
+        return;
+
+    uint64_t span = desperateOverview_trace_begin();
+    gboolean touched[MAX_WS] = { FALSE };
+    gboolean moved = FALSE;
+    uint64_t now = desperateOverview_metrics_now_ns();
+    guint batch = g_next_batch++;
+    if (g_next_batch == 0)
+        g_next_batch = 1;
+    for (int i = 0; i < n && workspace_listed(target_ws); ++i) {
+        int source_ws, index;
+        /* A move without a table entry could be neither re-applied nor
+         * rolled back, so it is only dispatched and shows up on refresh. */
+        if (!find_window(list[i], &source_ws, &index) || source_ws == target_ws ||
+            !reserve_pending() || !relocate_window(source_ws, index, target_ws))
+            continue;
+        PendingMove *move = &g_pending_moves[g_pending_count++];
+        g_strlcpy(move->addr, list[i], sizeof(move->addr));
+        move->source_ws = source_ws;
+        move->target_ws = target_ws;
+        move->settle_from_ns = now;
+        move->batch = batch;
+        move->in_flight = TRUE;
+        touched[source_ws] = TRUE;
+        touched[target_ws] = TRUE;
+        moved = TRUE;
+    }
+    if (moved)
+        queue_move_redraw(touched);
+    desperateOverview_core_move_windows_async(list, n, target_ws, move_done,
+                                              GUINT_TO_POINTER(batch));
+    if (span) {
+        char detail[32];
+        g_snprintf(detail, sizeof(detail), "%d windows", n);
+        desperateOverview_trace_end("move_windows", span, detail);
+    }
+}
+
+void desperateOverview_ui_move_window(const char *addr, int target_ws) {
+    desperateOverview_ui_move_windows(&addr, 1, target_ws);
+}
+
+static int find_selected(const char *addr) {
+    for (int i = 0; i < g_selection_count; ++i) {
+        if (strcmp(g_selection[i], addr) == 0)
+            return i;
+    }
+    return -1;
+}
+
+gboolean desperateOverview_ui_selection_toggle(const WindowInfo *win) {
+    if (!win || !win->addr[0])
+        return FALSE;
+    int index = find_selected(win->addr);
+    if (index >= 0) {
+        memmove(g_selection[index], g_selection[index + 1],
+                sizeof(g_selection[0]) * (size_t)(g_selection_count - index - 1));
+        g_selection_count--;
+        return FALSE;
+    }
+    if (g_selection_count >= MAX_WINS_PER_WS)
+        return FALSE;
+    g_strlcpy(g_selection[g_selection_count++], win->addr, sizeof(g_selection[0]));
+    return TRUE;
+}
+
+gboolean desperateOverview_ui_selection_contains(const WindowInfo *win) {
+    return win && g_selection_count > 0 && find_selected(win->addr) >= 0;
+}
+
+int desperateOverview_ui_selection_get(const char **addrs, int max) {
+    int n = g_selection_count < max ? g_selection_count : max;
+    for (int i = 0; i < n; ++i)
+        addrs[i] = g_selection[i];
+    return n;
+}
+
+/* Repaints the cells (and the preview) that show a selection highlight. */
+void desperateOverview_ui_selection_clear(void) {
+    gboolean touched[MAX_WS] = { FALSE };
+    for (int i = 0; i < g_selection_count; ++i) {
+        int wsid, index;
+        if (find_window(g_selection[i], &wsid, &index))
+            touched[wsid] = TRUE;
+    }
+    g_selection_count = 0;
+    if (!g_overlay_visible)
+        return;
+    for (int wsid = 1; wsid < MAX_WS; ++wsid) {
+        if (touched[wsid])
+            desperateOverview_ui_strip_queue_cell(wsid);
+    }
+    if (g_current_preview && g_active_workspace > 0 && g_active_workspace < MAX_WS &&
+        touched[g_active_workspace])
+        gtk_widget_queue_draw(g_current_preview);
+}
+
+void desperateOverview_ui_moves_reconcile(void) {
+    uint64_t now = desperateOverview_metrics_now_ns();
+    int write = 0;
+    for (int i = 0; i < g_pending_count; ++i) {
+        PendingMove *move = &g_pending_moves[i];
+        int wsid, index;
+        /* Landed, closed, timed out or no longer placeable: the snapshot stands. */
+        if (!find_window(move->addr, &wsid, &index) || wsid != move->source_ws ||
+            (!move->in_flight && now - move->settle_from_ns > G_MOVE_SETTLE_NS) ||
+            !workspace_listed(move->target_ws))
+            continue;
+        if (!relocate_window(wsid, index, move->target_ws))
+            continue;
+        g_pending_moves[write++] = *move;
+    }
+    g_pending_count = write;
+}
@@ -0,0 +1,240 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_preview_layout.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "desperateOverview_geometry.h"
+#include "desperateOverview_ui_render.h"
+#include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_strip.h"
+
+/* Inset of the window area inside a strip cell. */
+static const double G_CELL_PAD_TOP    = 8.0;
+static const double G_CELL_PAD_SIDES  = 8.0;
+static const double G_CELL_PAD_BOTTOM = 10.0;
+
+G_STATIC_ASSERT(MAX_WINS_PER_WS <= 32);
+
+/* Starts at 1 so zeroed layouts read as stale. */
+static guint64 g_layout_generation = 1;
+static DesperateOverviewPreviewLayout g_cell_layouts[MAX_WS];
+static DesperateOverviewPreviewLayout g_current_layout;
+static int g_sort_wsid;     /* workspace of the layout being sorted */
+
+void desperateOverview_ui_preview_layout_invalidate(void) {
+    ++g_layout_generation;
+}
+
+static gboolean layout_is_current(const DesperateOverviewPreviewLayout *layout, int wsid,
+                                  double width, double height) {
+    return layout->generation == g_layout_generation && layout->wsid == wsid &&
+           layout->width == width && layout->height == height;
+}
+
+static void layout_begin(DesperateOverviewPreviewLayout *layout, int wsid,
+                         double width, double height) {
+    layout->wsid = wsid;
+    layout->width = width;
+    layout->height = height;
+    layout->generation = g_layout_generation;
+    layout->count = 0;
+}
+
+/* Hyprland draws floating windows over tiled ones and, within a layer,
+ * the most recently focused (lowest focusHistoryID) on top. Windows it
+ * has no history for stay below, in client list order. */
+static int stacking_rank(const WindowInfo *win) {
+    int rank = win->focus_history_id >= 0 ? MAX_WS * MAX_WINS_PER_WS - win->focus_history_id : 0;
+    return win->floating ? rank + MAX_WS * MAX_WINS_PER_WS + 1 : rank;
+}
+
+static int compare_slots(const void *a, const void *b) {
+    const DesperateOverviewPreviewSlot *sa = a;
+    const DesperateOverviewPreviewSlot *sb = b;
+    WorkspaceWindows *W = &g_ws[g_sort_wsid];
+    int ra = stacking_rank(&W->wins[sa->index]);
+    int rb = stacking_rank(&W->wins[sb->index]);
+    if (ra != rb)
+        return ra < rb ? -1 : 1;
+    return sa->index - sb->index;
+}
+
+static int grid_bucket(double pos, double extent) {
+    int bucket = (int)(pos / extent * DESPERATEOVERVIEW_PREVIEW_GRID);
+    if (bucket < 0)
+        return 0;
+    if (bucket >= DESPERATEOVERVIEW_PREVIEW_GRID)
+        return DESPERATEOVERVIEW_PREVIEW_GRID - 1;
+    return bucket;
+}
+
+/* Puts the slots in stacking order and indexes them into the grid. */
+static void layout_finish(DesperateOverviewPreviewLayout *layout) {
+    g_sort_wsid = layout->wsid;
+    qsort(layout->slots, layout->count, sizeof(layout->slots[0]), compare_slots);
+
+    memset(layout->grid, 0, sizeof(layout->grid));
+    for (int i = 0; i < layout->count; ++i) {
+        const DesperateOverviewPreviewSlot *slot = &layout->slots[i];
+        int gx0 = grid_bucket(slot->x, layout->width);
+        int gx1 = grid_bucket(slot->x + slot->w, layout->width);
+        int gy0 = grid_bucket(slot->y, layout->height);
+        int gy1 = grid_bucket(slot->y + slot->h, layout->height);
+        for (int gy = gy0; gy <= gy1; ++gy) {
+            for (int gx = gx0; gx <= gx1; ++gx)
+                layout->grid[gy * DESPERATEOVERVIEW_PREVIEW_GRID + gx] |= 1u << i;
+        }
+    }
+}
+
+static void layout_add(DesperateOverviewPreviewLayout *layout, int index,
+                       double x, double y, double w, double h) {
+    DesperateOverviewPreviewSlot *slot = &layout->slots[layout->count++];
+    slot->x = (float)x;
+    slot->y = (float)y;
+    slot->w = (float)w;
+    slot->h = (float)h;
+    slot->index = index;
+}
+
+static void window_normalized(const WindowInfo *win, OverviewRect *norm) {
+    desperateOverview_geometry_window_to_normalized(
+        g_mon_width, g_mon_height, g_mon_off_x, g_mon_off_y, g_mon_transform,
+        win->x, win->y, win->w, win->h, norm);
+}
+
+/* Places every window of the workspace inside a W x H cell, clamped to
+ * the padded window area. */
+static void layout_cell(DesperateOverviewPreviewLayout *layout, int wsid, double W, double H) {
+    layout_begin(layout, wsid, W, H);
+    layout->frame_x = 0.0;
+    layout->frame_y = 0.0;
+    layout->frame_w = W;
+    layout->frame_h = H;
+
+    WorkspaceWindows *Wws = &g_ws[wsid];
+    double inner_w = W - 2.0 * G_CELL_PAD_SIDES;
+    double inner_h = H - G_CELL_PAD_TOP - G_CELL_PAD_BOTTOM;
+    double ix = G_CELL_PAD_SIDES;
+    double iy = G_CELL_PAD_TOP;
+
+    for (int i = 0; i < Wws->count; ++i) {
+        WindowInfo *win = &Wws->wins[i];
+        win->top_preview_valid = FALSE;
+        if (inner_w <= 0 || inner_h <= 0 || win->w <= 0 || win->h <= 0)
+            continue;
+
+        OverviewRect norm;
+        window_normalized(win, &norm);
+
+        double rx = ix + norm.x * inner_w;
+        double ry = iy + norm.y * inner_h;
+        double rw = desperateOverview_geometry_clamp(norm.w * inner_w, 5.0, inner_w);
+        double rh = desperateOverview_geometry_clamp(norm.h * inner_h, 5.0, inner_h);
+
+        if (rx < ix) rx = ix;
+        if (ry < iy) ry = iy;
+        if (rx + rw > ix + inner_w) rw = (ix + inner_w) - rx;
+        if (ry + rh > iy + inner_h) rh = (iy + inner_h) - ry;
+
+        if (rw <= 0 || rh <= 0)
+            continue;
+
+        layout_add(layout, i, rx, ry, rw, rh);
+        desperateOverview_ui_cache_window_preview(win, rx, ry, rw, rh, FALSE);
+    }
+    layout_finish(layout);
+}
+
+/* Fits the monitor into the current preview and places the active
+ * workspace's windows in that frame. */
+static void layout_current(DesperateOverviewPreviewLayout *layout, int wsid,
+                           double width, double height) {
+    layout_begin(layout, wsid, width, height);
+
+    int eff_w = desperateOverview_ui_get_effective_mon_width();
+    int eff_h = desperateOverview_ui_get_effective_mon_height();
+    if (eff_w <= 0 || eff_h <= 0) {
+        layout->frame_w = layout->frame_h = 0.0;
+        layout_finish(layout);
+        return;
+    }
+
+    OverviewPreviewTransform transform;
+    desperateOverview_geometry_compute_preview_transform(eff_w, eff_h, width, height, &transform);
+    layout->frame_x = transform.offset_x;
+    layout->frame_y = transform.offset_y;
+    layout->frame_w = transform.view_w;
+    layout->frame_h = transform.view_h;
+
+    WorkspaceWindows *Wws = &g_ws[wsid];
+    for (int i = 0; i < Wws->count; ++i) {
+        WindowInfo *win = &Wws->wins[i];
+        win->bottom_preview_valid = FALSE;
+        if (win->w <= 0 || win->h <= 0)
+            continue;
+
+        OverviewRect norm;
+        window_normalized(win, &norm);
+
+        double rx = transform.offset_x + norm.x * transform.view_w;
+        double ry = transform.offset_y + norm.y * transform.view_h;
+        double rw = desperateOverview_geometry_clamp(norm.w * transform.view_w, 2.0, transform.view_w);
+        double rh = desperateOverview_geometry_clamp(norm.h * transform.view_h, 2.0, transform.view_h);
+
+        layout_add(layout, i, rx, ry, rw, rh);
+        desperateOverview_ui_cache_window_preview(win, rx, ry, rw, rh, TRUE);
+    }
+    layout_finish(layout);
+}
+
+const DesperateOverviewPreviewLayout *desperateOverview_ui_preview_layout_cell(int wsid, double width, double height) {
+    if (wsid <= 0 || wsid >= MAX_WS || width <= 0 || height <= 0)
+        return NULL;
+    DesperateOverviewPreviewLayout *layout = &g_cell_layouts[wsid];
+    if (!layout_is_current(layout, wsid, width, height))
+        layout_cell(layout, wsid, width, height);
+    return layout;
+}
+
+const DesperateOverviewPreviewLayout *desperateOverview_ui_preview_layout_current(double width, double height) {
+    int wsid = g_active_workspace;
+    if (wsid <= 0 || wsid >= MAX_WS || width <= 0 || height <= 0)
+        return NULL;
+    DesperateOverviewPreviewLayout *layout = &g_current_layout;
+    if (!layout_is_current(layout, wsid, width, height))
+        layout_current(layout, wsid, width, height);
+    return layout;
+}
+
+void desperateOverview_ui_preview_layout_refresh(void) {
+    double cell_w, cell_h;
+    desperateOverview_ui_strip_get_cell_size(&cell_w, &cell_h);
+    if (g_cell_strip) {
+        for (int i = 0; i < g_active_count; ++i)
+            desperateOverview_ui_preview_layout_cell(g_active_list[i], cell_w, cell_h);
+    }
+    if (g_current_preview) {
+        GtkAllocation alloc;
+        gtk_widget_get_allocation(g_current_preview, &alloc);
+        desperateOverview_ui_preview_layout_current(alloc.width, alloc.height);
+    }
+}
+
+WindowInfo *desperateOverview_ui_preview_layout_hit(const DesperateOverviewPreviewLayout *layout,
+                                                    double x, double y) {
+    if (!layout || x < 0 || y < 0 || x > layout->width || y > layout->height)
+        return NULL;
+    WorkspaceWindows *W = &g_ws[layout->wsid];
+    guint32 mask = layout->grid[grid_bucket(y, layout->height) * DESPERATEOVERVIEW_PREVIEW_GRID +
+                                grid_bucket(x, layout->width)];
+    for (gint i = g_bit_nth_msf(mask, -1); i >= 0; i = g_bit_nth_msf(mask, i)) {
+        const DesperateOverviewPreviewSlot *slot = &layout->slots[i];
+        if (x >= slot->x && x <= slot->x + slot->w &&
+            y >= slot->y && y <= slot->y + slot->h)
+            return &W->wins[slot->index];
+    }
+    return NULL;
+}
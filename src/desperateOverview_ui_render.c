@@ -3,85 +3,101 @@
 #include "desperateOverview_ui_render.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "desperateOverview_config.h"
-#include "desperateOverview_geometry.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_trace.h"
 #include "desperateOverview_ui_drawing.h"
+#include "desperateOverview_ui_moves.h"
+#include "desperateOverview_ui_preview_layout.h"
 #include "desperateOverview_ui_state.h"
+#include "desperateOverview_ui_strip.h"
+#include "desperateOverview_ui_surface_cache.h"
 
 static const double G_WINDOW_BORDER_WIDTH = 2.0;
 
-GdkPixbuf *desperateOverview_ui_orient_pixbuf(GdkPixbuf *src) {
-    if (!src)
-        return NULL;
+/* Transient animation state, driven by desperateOverview_ui_anim. */
+static double g_current_slide = 0.0;
+static double g_cell_flash[MAX_WS];
 
-    int t = g_mon_transform % 4;
-    if (t < 0)
-        t += 4;
-
-    if (t == 0)
-        return g_object_ref(src);
-
-    GdkPixbufRotation rotation = GDK_PIXBUF_ROTATE_NONE;
-    switch (t) {
-        case 1:
-            rotation = GDK_PIXBUF_ROTATE_CLOCKWISE;
-            break;
-        case 2:
-            rotation = GDK_PIXBUF_ROTATE_UPSIDEDOWN;
-            break;
-        case 3:
-            rotation = GDK_PIXBUF_ROTATE_COUNTERCLOCKWISE;
-            break;
-        default:
-            rotation = GDK_PIXBUF_ROTATE_NONE;
-            break;
-    }
+void desperateOverview_ui_render_set_current_slide(double offset) {
+    g_current_slide = offset;
+}
+
+void desperateOverview_ui_render_set_cell_flash(int wsid, double alpha) {
+    if (wsid > 0 && wsid < MAX_WS)
+        g_cell_flash[wsid] = alpha;
+}
 
-    GdkPixbuf *rotated = gdk_pixbuf_rotate_simple(src, rotation);
-    if (!rotated)
-        return g_object_ref(src);
-    return rotated;
+/* Damage is queued per window rect, so most draws only need the windows
+ * that intersect the clip. The margin covers borders stroked on the edge. */
+static gboolean rect_outside_clip(double cx0, double cy0, double cx1, double cy1,
+                                  double x, double y, double w, double h) {
+    const double margin = 3.0;
+    return x + w + margin < cx0 || y + h + margin < cy0 ||
+           x - margin > cx1 || y - margin > cy1;
 }
 
+static void draw_drag_highlight(cairo_t *cr,
+                                double rx,
+                                double ry,
+                                double rw,
+                                double rh,
+                                const OverlayConfig *cfg) {
+    cairo_save(cr);
+    cairo_add_rounded_rect(cr, rx, ry, rw, rh, cfg->window_corner_radius);
+    double fill_alpha = fmin(1.0, cfg->drag_highlight.alpha * 0.35);
+    cairo_set_source_rgba(cr,
+                          cfg->drag_highlight.red,
+                          cfg->drag_highlight.green,
+                          cfg->drag_highlight.blue,
+                          fill_alpha);
+    cairo_fill_preserve(cr);
+    double dash[] = {6.0, 4.0};
+    cairo_set_dash(cr, dash, 2, 0);
+    cairo_set_line_width(cr, 3.0);
+    cairo_set_source_rgba_color(cr, &cfg->drag_highlight);
+    cairo_stroke(cr);
+    cairo_restore(cr);
+}
+
+/* `decorate` adds the selection highlight; cached cell layers leave it out
+ * and get it composited on top instead. The drag highlight is drawn by the
+ * drag layer. */
 static void draw_window_preview(cairo_t *cr,
                                 WindowInfo *win,
                                 GdkPixbuf *source,
+                                DesperateOverviewSurfaceView view,
                                 double rx,
                                 double ry,
                                 double rw,
                                 double rh,
-                                const OverlayConfig *cfg) {
+                                const OverlayConfig *cfg,
+                                gboolean decorate) {
     if (!win || !cfg)
         return;
 
     gboolean drew_texture = FALSE;
     if (source) {
-        GdkPixbuf *oriented = desperateOverview_ui_orient_pixbuf(source);
         int target_w = (int)ceil(rw);
         int target_h = (int)ceil(rh);
         if (target_w <= 0) target_w = 1;
         if (target_h <= 0) target_h = 1;
 
-        if (oriented) {
-            GdkPixbuf *scaled = gdk_pixbuf_scale_simple(
-                oriented,
-                target_w,
-                target_h,
-                GDK_INTERP_BILINEAR
-            );
-
-            if (scaled) {
-                cairo_save(cr);
-                cairo_add_rounded_rect(cr, rx, ry, rw, rh, cfg->window_corner_radius);
-                cairo_clip(cr);
-                gdk_cairo_set_source_pixbuf(cr, scaled, rx, ry);
-                cairo_paint(cr);
-                cairo_restore(cr);
-                g_object_unref(scaled);
-                drew_texture = TRUE;
-            }
-            g_object_unref(oriented);
+        /* Live frames are fresh pixbufs, so only the thumbnail carries a crc. */
+        guint32 content_crc = (source == win->thumb_pixbuf) ? win->thumb_crc : 0;
+        cairo_surface_t *surface = desperateOverview_surface_cache_get(
+            win->addr, view, source, content_crc, target_w, target_h);
+        if (surface) {
+            cairo_save(cr);
+            cairo_add_rounded_rect(cr, rx, ry, rw, rh, cfg->window_corner_radius);
+            cairo_clip(cr);
+            cairo_set_source_surface(cr, surface, rx, ry);
+            cairo_paint(cr);
+            cairo_restore(cr);
+            cairo_surface_destroy(surface);
+            drew_texture = TRUE;
         }
     }
 
@@ -93,23 +109,8 @@ static void draw_window_preview(cairo_t *cr,
         cairo_restore(cr);
     }
 
-    if (g_drag.in_progress && g_drag.active_window == win) {
-        cairo_save(cr);
-        cairo_add_rounded_rect(cr, rx, ry, rw, rh, cfg->window_corner_radius);
-        double fill_alpha = fmin(1.0, cfg->drag_highlight.alpha * 0.35);
-        cairo_set_source_rgba(cr,
-                              cfg->drag_highlight.red,
-                              cfg->drag_highlight.green,
-                              cfg->drag_highlight.blue,
-                              fill_alpha);
-        cairo_fill_preserve(cr);
-        double dash[] = {6.0, 4.0};
-        cairo_set_dash(cr, dash, 2, 0);
-        cairo_set_line_width(cr, 3.0);
-        cairo_set_source_rgba_color(cr, &cfg->drag_highlight);
-        cairo_stroke(cr);
-        cairo_restore(cr);
-    }
+    if (decorate && desperateOverview_ui_selection_contains(win))
+        draw_drag_highlight(cr, rx, ry, rw, rh, cfg);
 
     ui_draw_window_border(cr, rx, ry, rw, rh, cfg, G_WINDOW_BORDER_WIDTH);
 }
@@ -155,6 +156,7 @@ static int get_effective_mon_height(void) {
 
 gboolean desperateOverview_ui_draw_background(GtkWidget *widget, cairo_t *cr, gpointer data) {
     (void)data;
+    uint64_t span = desperateOverview_trace_begin();
     GtkAllocation alloc;
     gtk_widget_get_allocation(widget, &alloc);
 
@@ -166,41 +168,28 @@ gboolean desperateOverview_ui_draw_background(GtkWidget *widget, cairo_t *cr, gp
     cairo_set_source_rgba_color(cr, &cfg->overlay_bg);
     cairo_rectangle(cr, 0, 0, width, height);
     cairo_fill(cr);
+    desperateOverview_trace_end("draw_background", span, NULL);
     return TRUE;
 }
 
-gboolean desperateOverview_ui_draw_current_workspace(GtkWidget *widget, cairo_t *cr, gpointer data) {
-    (void)data;
-    GtkAllocation alloc;
-    gtk_widget_get_allocation(widget, &alloc);
-    double width = alloc.width;
-    double height = alloc.height;
-    if (width <= 0 || height <= 0)
-        return FALSE;
-
-    if (g_active_workspace <= 0 || g_active_workspace >= MAX_WS)
-        return TRUE;
-
-    int eff_w = get_effective_mon_width();
-    int eff_h = get_effective_mon_height();
-    if (eff_w <= 0 || eff_h <= 0)
-        return TRUE;
-
-    WorkspaceWindows *Wws = &g_ws[g_active_workspace];
-    if (!Wws)
-        return TRUE;
+void desperateOverview_ui_render_current_workspace(cairo_t *cr, double width, double height) {
+    const DesperateOverviewPreviewLayout *layout =
+        desperateOverview_ui_preview_layout_current(width, height);
+    if (!layout || layout->frame_w <= 0 || layout->frame_h <= 0)
+        return;
 
-    OverviewPreviewTransform transform;
-    desperateOverview_geometry_compute_preview_transform(
-        eff_w, eff_h, width, height, &transform);
+    WorkspaceWindows *Wws = &g_ws[layout->wsid];
+    /* The slide is a draw-time offset; the layout stays put while it runs. */
+    double slide = g_current_slide * width;
 
     const OverlayConfig *cfg = config_get();
     cairo_save(cr);
+    cairo_translate(cr, slide, 0.0);
     cairo_add_rounded_rect(cr,
-                           transform.offset_x,
-                           transform.offset_y,
-                           transform.view_w,
-                           transform.view_h,
+                           layout->frame_x,
+                           layout->frame_y,
+                           layout->frame_w,
+                           layout->frame_h,
                            cfg->workspace_corner_radius);
     cairo_set_source_rgba_color(cr, &cfg->active_ws_bg);
     cairo_fill_preserve(cr);
@@ -208,64 +197,93 @@ gboolean desperateOverview_ui_draw_current_workspace(GtkWidget *widget, cairo_t
     cairo_set_source_rgba_color(cr, &cfg->active_ws_border);
     cairo_stroke(cr);
 
-    g_current_preview_rect.x = transform.offset_x;
-    g_current_preview_rect.y = transform.offset_y;
-    g_current_preview_rect.w = transform.view_w;
-    g_current_preview_rect.h = transform.view_h;
+    g_current_preview_rect.x = layout->frame_x + slide;
+    g_current_preview_rect.y = layout->frame_y;
+    g_current_preview_rect.w = layout->frame_w;
+    g_current_preview_rect.h = layout->frame_h;
     g_current_preview_rect.valid = TRUE;
 
-    if (Wws->count <= 0) {
-        cairo_restore(cr);
-        return TRUE;
-    }
+    double cx0, cy0, cx1, cy1;
+    cairo_clip_extents(cr, &cx0, &cy0, &cx1, &cy1);
 
-    for (int i = 0; i < Wws->count; ++i) {
-        WindowInfo *win = &Wws->wins[i];
-        if (!win || win->w <= 0 || win->h <= 0) {
-            if (win)
-                win->bottom_preview_valid = FALSE;
+    for (int i = 0; i < layout->count; ++i) {
+        const DesperateOverviewPreviewSlot *slot = &layout->slots[i];
+        if (rect_outside_clip(cx0, cy0, cx1, cy1, slot->x, slot->y, slot->w, slot->h))
             continue;
-        }
-        win->bottom_preview_valid = FALSE;
-
-        OverviewRect norm;
-        desperateOverview_geometry_window_to_normalized(
-            g_mon_width, g_mon_height, g_mon_off_x, g_mon_off_y, g_mon_transform,
-            win->x, win->y, win->w, win->h, &norm);
-
-        double rx = transform.offset_x + norm.x * transform.view_w;
-        double ry = transform.offset_y + norm.y * transform.view_h;
-        double rw = norm.w * transform.view_w;
-        double rh = norm.h * transform.view_h;
-
-        rw = desperateOverview_geometry_clamp(rw, 2.0, transform.view_w);
-        rh = desperateOverview_geometry_clamp(rh, 2.0, transform.view_h);
-
-        desperateOverview_ui_cache_window_preview(win, rx, ry, rw, rh, TRUE);
+        WindowInfo *win = &Wws->wins[slot->index];
         GdkPixbuf *preview = win->live_pixbuf ? win->live_pixbuf : win->thumb_pixbuf;
-        draw_window_preview(cr, win, preview, rx, ry, rw, rh, cfg);
+        draw_window_preview(cr, win, preview, DESPERATEOVERVIEW_SURFACE_VIEW_CURRENT,
+                            slot->x, slot->y, slot->w, slot->h, cfg, TRUE);
     }
 
     cairo_restore(cr);
-    return TRUE;
 }
 
-gboolean desperateOverview_ui_draw_cell(GtkWidget *widget, cairo_t *cr, gpointer data) {
-    int wsid = GPOINTER_TO_INT(data);
+/* Closes the end-to-end marks once a frame with the new state is drawn. */
+static void note_frame_drawn(void) {
+    uint64_t start = desperateOverview_metrics_mark_take(DESPERATEOVERVIEW_MARK_SHOW);
+    if (start)
+        desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_SHOW_TO_FRAME, start);
+    start = desperateOverview_metrics_mark_take(DESPERATEOVERVIEW_MARK_EVENT_APPLIED);
+    if (start)
+        desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_EVENT_TO_FRAME, start);
+}
 
-    GtkAllocation a;
-    gtk_widget_get_allocation(widget, &a);
-    double W = a.width;
-    double H = a.height;
+gboolean desperateOverview_ui_draw_current_workspace(GtkWidget *widget, cairo_t *cr, gpointer data) {
+    (void)data;
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(widget, &alloc);
+    if (alloc.width <= 0 || alloc.height <= 0)
+        return FALSE;
+
+    uint64_t span = desperateOverview_trace_begin();
+    uint64_t draw_start = desperateOverview_metrics_now_ns();
+    desperateOverview_ui_render_current_workspace(cr, alloc.width, alloc.height);
+    desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_DRAW_CURRENT, draw_start);
+    desperateOverview_trace_end("draw_current_workspace", span, NULL);
+    note_frame_drawn();
+    return TRUE;
+}
 
+/* Everything in a cell that only changes with the workspace's windows or
+ * thumbnails: background, window previews and their borders. */
+static void render_cell_content(cairo_t *cr, const DesperateOverviewPreviewLayout *layout,
+                                const OverlayConfig *cfg) {
+    int wsid = layout->wsid;
+    double W = layout->width;
+    double H = layout->height;
     cairo_save(cr);
-    const OverlayConfig *cfg = config_get();
     cairo_add_rounded_rect(cr, 2.0, 2.0, W - 4.0, H - 4.0, cfg->workspace_corner_radius);
     if (wsid == g_active_workspace)
         cairo_set_source_rgba_color(cr, &cfg->active_ws_bg);
     else
         cairo_set_source_rgba_color(cr, &cfg->inactive_ws_bg);
-    cairo_fill_preserve(cr);
+    cairo_fill(cr);
+    cairo_restore(cr);
+
+    double cx0, cy0, cx1, cy1;
+    cairo_clip_extents(cr, &cx0, &cy0, &cx1, &cy1);
+
+    WorkspaceWindows *Wws = &g_ws[wsid];
+    for (int i = 0; i < layout->count; ++i) {
+        const DesperateOverviewPreviewSlot *slot = &layout->slots[i];
+        if (rect_outside_clip(cx0, cy0, cx1, cy1, slot->x, slot->y, slot->w, slot->h))
+            continue;
+        WindowInfo *win = &Wws->wins[slot->index];
+        draw_window_preview(cr, win, win->thumb_pixbuf, DESPERATEOVERVIEW_SURFACE_VIEW_CELL,
+                            slot->x, slot->y, slot->w, slot->h, cfg, FALSE);
+    }
+}
+
+/* Workspace border, drop flash and selection highlight, drawn over the
+ * cached layer. */
+static void render_cell_decorations(cairo_t *cr, const DesperateOverviewPreviewLayout *layout,
+                                    const OverlayConfig *cfg) {
+    int wsid = layout->wsid;
+    double W = layout->width;
+    double H = layout->height;
+    cairo_save(cr);
+    cairo_add_rounded_rect(cr, 2.0, 2.0, W - 4.0, H - 4.0, cfg->workspace_corner_radius);
     cairo_set_line_width(cr, 3.0);
     if (wsid == g_active_workspace)
         cairo_set_source_rgba_color(cr, &cfg->active_ws_border);
@@ -273,59 +291,196 @@ gboolean desperateOverview_ui_draw_cell(GtkWidget *widget, cairo_t *cr, gpointer
         cairo_set_source_rgba_color(cr, &cfg->inactive_ws_border);
     cairo_stroke(cr);
 
+    double highlight = g_cell_flash[wsid];
+    if (highlight > 0.0) {
+        cairo_add_rounded_rect(cr, 2.0, 2.0, W - 4.0, H - 4.0, cfg->workspace_corner_radius);
+        cairo_set_source_rgba(cr,
+                              cfg->drag_highlight.red,
+                              cfg->drag_highlight.green,
+                              cfg->drag_highlight.blue,
+                              cfg->drag_highlight.alpha * highlight);
+        cairo_set_line_width(cr, 4.0);
+        cairo_stroke(cr);
+    }
     cairo_restore(cr);
 
+    WorkspaceWindows *Wws = &g_ws[wsid];
+    for (int i = 0; i < layout->count; ++i) {
+        const DesperateOverviewPreviewSlot *slot = &layout->slots[i];
+        if (!desperateOverview_ui_selection_contains(&Wws->wins[slot->index]))
+            continue;
+        draw_drag_highlight(cr, slot->x, slot->y, slot->w, slot->h, cfg);
+        ui_draw_window_border(cr, slot->x, slot->y, slot->w, slot->h, cfg, G_WINDOW_BORDER_WIDTH);
+    }
+}
+
+void desperateOverview_ui_render_drag_window(cairo_t *cr, double x, double y, double w, double h) {
+    const OverlayConfig *cfg = config_get();
+    draw_drag_highlight(cr, x, y, w, h, cfg);
+    ui_draw_window_border(cr, x, y, w, h, cfg, G_WINDOW_BORDER_WIDTH);
+}
+
+void desperateOverview_ui_render_drop_target(cairo_t *cr, double W, double H) {
+    const OverlayConfig *cfg = config_get();
     cairo_save(cr);
+    cairo_add_rounded_rect(cr, 2.0, 2.0, W - 4.0, H - 4.0, cfg->workspace_corner_radius);
+    cairo_set_source_rgba_color(cr, &cfg->drag_highlight);
+    cairo_set_line_width(cr, 4.0);
+    cairo_stroke(cr);
+    cairo_restore(cr);
+}
 
-    WorkspaceWindows *Wws = &g_ws[wsid];
-    if (Wws->count <= 0)
-        goto out_restore_cell;
+typedef struct {
+    cairo_surface_t *surface;
+    guint64 signature;
+} CellLayer;
 
-    double pad_top    = 8.0;
-    double pad_sides  = 8.0;
-    double pad_bottom = 10.0;
+static CellLayer g_cell_layers[MAX_WS];
 
-    double inner_w = W - 2.0 * pad_sides;
-    double inner_h = H - pad_top - pad_bottom;
-    if (inner_w <= 0 || inner_h <= 0)
-        goto out_restore_cell;
+static guint64 signature_mix(guint64 hash, guint64 value) {
+    /* FNV-1a over the 8 bytes of value. */
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xffu;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
 
-    double ix = pad_sides;
-    double iy = pad_top;
+static guint64 signature_mix_double(guint64 hash, double value) {
+    guint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return signature_mix(hash, bits);
+}
 
-    for (int i = 0; i < Wws->count; ++i) {
-        WindowInfo *win = &Wws->wins[i];
-        win->top_preview_valid = FALSE;
-        if (win->w <= 0 || win->h <= 0)
-            continue;
+/* Covers every input of render_cell_content(). The thumbnail crc guards
+ * against a new pixbuf reusing a freed one's address. */
+static guint64 cell_content_signature(const DesperateOverviewPreviewLayout *layout) {
+    const WorkspaceWindows *Wws = &g_ws[layout->wsid];
+    guint64 hash = 0xcbf29ce484222325ull;
+    hash = signature_mix_double(hash, layout->width);
+    hash = signature_mix_double(hash, layout->height);
+    hash = signature_mix(hash, layout->wsid == g_active_workspace);
+    hash = signature_mix(hash, (guint64)layout->count);
+    for (int i = 0; i < layout->count; ++i) {
+        const DesperateOverviewPreviewSlot *slot = &layout->slots[i];
+        const WindowInfo *win = &Wws->wins[slot->index];
+        hash = signature_mix(hash, (guint64)slot->index);
+        hash = signature_mix_double(hash, slot->x);
+        hash = signature_mix_double(hash, slot->y);
+        hash = signature_mix_double(hash, slot->w);
+        hash = signature_mix_double(hash, slot->h);
+        hash = signature_mix(hash, (guint64)(uintptr_t)win->thumb_pixbuf);
+        hash = signature_mix(hash, win->thumb_crc);
+    }
+    return hash;
+}
 
-        OverviewRect norm;
-        desperateOverview_geometry_window_to_normalized(
-            g_mon_width, g_mon_height, g_mon_off_x, g_mon_off_y, g_mon_transform,
-            win->x, win->y, win->w, win->h, &norm);
+void desperateOverview_ui_render_invalidate_cells(void) {
+    desperateOverview_ui_preview_layout_invalidate();
+    for (int i = 0; i < MAX_WS; ++i) {
+        if (g_cell_layers[i].surface)
+            cairo_surface_destroy(g_cell_layers[i].surface);
+        g_cell_layers[i].surface = NULL;
+        g_cell_layers[i].signature = 0;
+    }
+}
 
-        double rx = ix + norm.x * inner_w;
-        double ry = iy + norm.y * inner_h;
-        double rw = norm.w * inner_w;
-        double rh = norm.h * inner_h;
+/* Returns the cell's layer, re-rendering it only when the content
+ * signature changed. NULL means the caller should draw directly. */
+static cairo_surface_t *cell_layer_get(cairo_t *cr, const DesperateOverviewPreviewLayout *layout,
+                                       const OverlayConfig *cfg) {
+    int wsid = layout->wsid;
+    CellLayer *layer = &g_cell_layers[wsid];
+    guint64 signature = cell_content_signature(layout);
+    if (layer->surface && layer->signature == signature)
+        return layer->surface;
+
+    if (layer->surface)
+        cairo_surface_destroy(layer->surface);
+    layer->surface = NULL;
+
+    int lw = (int)ceil(layout->width);
+    int lh = (int)ceil(layout->height);
+    /* Similar to the target so the layer shares its backend and device scale. */
+    cairo_surface_t *surface = cairo_surface_create_similar(
+        cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA, lw, lh);
+    if (!surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        if (surface)
+            cairo_surface_destroy(surface);
+        return NULL;
+    }
 
-        rw = desperateOverview_geometry_clamp(rw, 5.0, inner_w);
-        rh = desperateOverview_geometry_clamp(rh, 5.0, inner_h);
+    uint64_t span = desperateOverview_trace_begin();
+    cairo_t *lcr = cairo_create(surface);
+    render_cell_content(lcr, layout, cfg);
+    cairo_destroy(lcr);
+    if (span) {
+        char detail[16];
+        g_snprintf(detail, sizeof(detail), "ws %d", wsid);
+        desperateOverview_trace_end("cell_layer_build", span, detail);
+    }
 
-        if (rx < ix) rx = ix;
-        if (ry < iy) ry = iy;
-        if (rx + rw > ix + inner_w) rw = (ix + inner_w) - rx;
-        if (ry + rh > iy + inner_h) rh = (iy + inner_h) - ry;
+    layer->surface = surface;
+    layer->signature = signature;
+    return surface;
+}
 
-        if (rw <= 0 || rh <= 0)
-            continue;
+void desperateOverview_ui_render_cell(cairo_t *cr, int wsid, double W, double H) {
+    if (wsid <= 0 || wsid >= MAX_WS || W <= 0 || H <= 0)
+        return;
 
-        desperateOverview_ui_cache_window_preview(win, rx, ry, rw, rh, FALSE);
-        draw_window_preview(cr, win, win->thumb_pixbuf, rx, ry, rw, rh, cfg);
+    const DesperateOverviewPreviewLayout *layout =
+        desperateOverview_ui_preview_layout_cell(wsid, W, H);
+    if (!layout)
+        return;
+    const OverlayConfig *cfg = config_get();
+
+    cairo_surface_t *layer = cell_layer_get(cr, layout, cfg);
+    if (layer) {
+        cairo_save(cr);
+        cairo_set_source_surface(cr, layer, 0, 0);
+        cairo_paint(cr);
+        cairo_restore(cr);
+    } else {
+        render_cell_content(cr, layout, cfg);
     }
+    render_cell_decorations(cr, layout, cfg);
+}
 
-out_restore_cell:
-    cairo_restore(cr);
+gboolean desperateOverview_ui_draw_strip(GtkWidget *widget, cairo_t *cr, gpointer data) {
+    (void)widget; (void)data;
+    double cell_w, cell_h;
+    desperateOverview_ui_strip_get_cell_size(&cell_w, &cell_h);
+    if (cell_w <= 0 || cell_h <= 0)
+        return FALSE;
+
+    double cx0, cy0, cx1, cy1;
+    cairo_clip_extents(cr, &cx0, &cy0, &cx1, &cy1);
+
+    for (int i = 0; i < g_active_count; ++i) {
+        int wsid = g_active_list[i];
+        if (wsid <= 0 || wsid >= MAX_WS)
+            continue;
+        double x, y;
+        desperateOverview_ui_strip_index_origin(i, &x, &y);
+        if (x + cell_w < cx0 || x > cx1 || y + cell_h < cy0 || y > cy1)
+            continue;
+
+        uint64_t span = desperateOverview_trace_begin();
+        uint64_t draw_start = desperateOverview_metrics_now_ns();
+        cairo_save(cr);
+        cairo_translate(cr, x, y);
+        cairo_rectangle(cr, 0.0, 0.0, cell_w, cell_h);
+        cairo_clip(cr);
+        desperateOverview_ui_render_cell(cr, wsid, cell_w, cell_h);
+        cairo_restore(cr);
+        desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_DRAW_CELL, draw_start);
+        if (span) {
+            char detail[16];
+            g_snprintf(detail, sizeof(detail), "ws %d", wsid);
+            desperateOverview_trace_end("draw_cell", span, detail);
+        }
+    }
+    note_frame_drawn();
     return TRUE;
 }
-
@@ -3,9 +3,11 @@
 #include "desperateOverview_ui_state.h"
 
 #include <gtk/gtk.h>
+#include <math.h>
 #include <string.h>
 
 #include "desperateOverview_config.h"
+#include "desperateOverview_ui_strip.h"
 
 int    g_mon_id         = 0;
 int    g_mon_width      = 1920;
@@ -20,7 +22,7 @@ WorkspaceWindows g_ws[MAX_WS];
 int    g_active_list[MAX_WS];
 int    g_active_count = 0;
 
-GtkWidget *g_cells[MAX_WS];
+GtkWidget *g_cell_strip = NULL;
 GtkWidget *g_overlay_window = NULL;
 GtkWidget *g_root_overlay = NULL;
 GtkWidget *g_root_box = NULL;
@@ -31,7 +33,7 @@ int g_built_active_count = 0;
 int g_built_active_list[MAX_WS];
 char g_built_active_names[MAX_WS][CORE_WS_NAME_LEN];
 gboolean g_overlay_visible = FALSE;
-guint g_fade_source_id = 0;
+guint g_fade_anim_id = 0;
 
 const gchar g_drag_target_name[] = "application/x-desperateoverview-window";
 const GtkTargetEntry g_drag_targets[] = {
@@ -69,15 +71,87 @@ int desperateOverview_ui_get_effective_mon_height(void) {
     return g_mon_height;
 }
 
-void desperateOverview_ui_queue_cells_redraw(void) {
-    for (int i = 0; i < g_active_count; ++i) {
-        if (g_cells[i])
-            gtk_widget_queue_draw(g_cells[i]);
+GdkMonitor *desperateOverview_ui_match_monitor(GdkDisplay *display) {
+    if (!display)
+        return NULL;
+
+    int eff_w = desperateOverview_ui_get_effective_mon_width();
+    int eff_h = desperateOverview_ui_get_effective_mon_height();
+    int monitors = gdk_display_get_n_monitors(display);
+    for (int i = 0; i < monitors; ++i) {
+        GdkMonitor *monitor = gdk_display_get_monitor(display, i);
+        if (!monitor)
+            continue;
+        GdkRectangle rect;
+        gdk_monitor_get_geometry(monitor, &rect);
+        if (rect.x == g_mon_off_x &&
+            rect.y == g_mon_off_y &&
+            rect.width == eff_w &&
+            rect.height == eff_h) {
+            return monitor;
+        }
+    }
+
+    return gdk_display_get_primary_monitor(display);
+}
+
+/* Covers the 3px dashed drag outline and the window border stroked on the
+ * rect's edge, plus antialiasing. */
+#define DAMAGE_MARGIN 3.0
+
+static void margin_rect(double x, double y, double w, double h, GdkRectangle *out) {
+    int x0 = (int)floor(x - DAMAGE_MARGIN);
+    int y0 = (int)floor(y - DAMAGE_MARGIN);
+    int x1 = (int)ceil(x + w + DAMAGE_MARGIN);
+    int y1 = (int)ceil(y + h + DAMAGE_MARGIN);
+    out->x = x0;
+    out->y = y0;
+    out->width = x1 - x0;
+    out->height = y1 - y0;
+}
+
+static void queue_rect_redraw(GtkWidget *widget, double x, double y, double w, double h) {
+    if (!widget || w <= 0 || h <= 0)
+        return;
+    GdkRectangle r;
+    margin_rect(x, y, w, h, &r);
+    gtk_widget_queue_draw_area(widget, r.x, r.y, r.width, r.height);
+}
+
+int desperateOverview_ui_find_window_workspace(const WindowInfo *win) {
+    if (!win)
+        return -1;
+    for (int wsid = 0; wsid < MAX_WS; ++wsid) {
+        const WorkspaceWindows *W = &g_ws[wsid];
+        if (win >= W->wins && win < W->wins + W->count)
+            return wsid;
+    }
+    return -1;
+}
+
+void desperateOverview_ui_queue_window_redraw(WindowInfo *win, gboolean top, gboolean bottom) {
+    int wsid = desperateOverview_ui_find_window_workspace(win);
+    if (wsid < 0)
+        return;
+
+    if (top) {
+        if (win->top_preview_valid) {
+            GdkRectangle r;
+            margin_rect(win->top_preview_x, win->top_preview_y,
+                        win->top_preview_w, win->top_preview_h, &r);
+            desperateOverview_ui_strip_queue_cell_area(wsid, r.x, r.y, r.width, r.height);
+        } else {
+            desperateOverview_ui_strip_queue_cell(wsid);
+        }
+    }
+
+    if (bottom && g_current_preview && wsid == g_active_workspace) {
+        if (win->bottom_preview_valid)
+            queue_rect_redraw(g_current_preview, win->bottom_preview_x, win->bottom_preview_y,
+                              win->bottom_preview_w, win->bottom_preview_h);
+        else
+            gtk_widget_queue_draw(g_current_preview);
     }
-    if (g_overlay_window)
-        gtk_widget_queue_draw(g_overlay_window);
-    if (g_current_preview)
-        gtk_widget_queue_draw(g_current_preview);
 }
 
 int desperateOverview_ui_find_active_index(int wsid) {
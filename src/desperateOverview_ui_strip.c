@@ -0,0 +1,284 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_strip.h"
+
+#include <math.h>
+
+#include "desperateOverview_core.h"
+#include "desperateOverview_ui_drag_layer.h"
+#include "desperateOverview_ui_events.h"
+#include "desperateOverview_ui_render.h"
+#include "desperateOverview_ui_state.h"
+
+static double g_strip_cell_w = 0.0;
+static double g_strip_cell_h = 0.0;
+static double g_strip_gap = 0.0;
+static int    g_strip_drop_ws = -1;
+
+/* Cell origins by active-list index, computed once per layout change and
+ * shared by drawing, hit testing and damage. */
+static double g_strip_cell_x[MAX_WS];
+static double g_strip_cell_y[MAX_WS];
+
+/* Cells on each side of the viewport whose thumbnails are captured ahead
+ * of scrolling or arrow-key navigation. */
+#define STRIP_PREFETCH_CELLS 2
+
+static GtkWidget *g_strip_scroller = NULL;
+static uint64_t   g_strip_capture_mask = CORE_CAPTURE_ALL_WORKSPACES;
+
+static GtkAdjustment *strip_hadjustment(void) {
+    if (!g_strip_scroller)
+        return NULL;
+    return gtk_scrolled_window_get_hadjustment(GTK_SCROLLED_WINDOW(g_strip_scroller));
+}
+
+static void ensure_cell_visible(int wsid) {
+    GtkAdjustment *adj = strip_hadjustment();
+    double x;
+    if (!adj || !desperateOverview_ui_strip_cell_origin(wsid, &x, NULL))
+        return;
+    double value = gtk_adjustment_get_value(adj);
+    double page = gtk_adjustment_get_page_size(adj);
+    if (page <= 0.0)
+        return;
+    if (x < value)
+        gtk_adjustment_set_value(adj, x);
+    else if (x + g_strip_cell_w > value + page)
+        gtk_adjustment_set_value(adj, x + g_strip_cell_w - page);
+}
+
+static void update_capture_window(void) {
+    GtkAdjustment *adj = strip_hadjustment();
+    double pitch = g_strip_cell_w + g_strip_gap;
+    if (!adj || pitch <= 0.0)
+        return;
+    double value = gtk_adjustment_get_value(adj);
+    double page = gtk_adjustment_get_page_size(adj);
+    int first = (int)floor(value / pitch);
+    int last = (int)floor((value + page) / pitch);
+    desperateOverview_ui_strip_capture_range(first - STRIP_PREFETCH_CELLS,
+                                             last + STRIP_PREFETCH_CELLS);
+}
+
+static void on_strip_scrolled(GtkAdjustment *adj, gpointer data) {
+    (void)adj; (void)data;
+    update_capture_window();
+}
+
+/* Page size and bounds change with the allocation: keep the active cell in
+ * view, which also covers the first allocation after the overlay opens. */
+static void on_strip_viewport_changed(GtkAdjustment *adj, gpointer data) {
+    (void)adj; (void)data;
+    ensure_cell_visible(g_active_workspace);
+    update_capture_window();
+}
+
+static void on_scroller_destroy(GtkWidget *widget, gpointer data) {
+    (void)data;
+    if (g_strip_scroller == widget)
+        g_strip_scroller = NULL;
+}
+
+/* The drop frame lives on the drag layer; the cells are not redrawn. */
+static void set_drop_target(int wsid) {
+    if (wsid == g_strip_drop_ws)
+        return;
+    g_strip_drop_ws = wsid;
+    desperateOverview_ui_drag_layer_update();
+}
+
+static gboolean on_strip_drag_motion(GtkWidget *widget, GdkDragContext *context,
+                                     gint x, gint y, guint time, gpointer data) {
+    (void)widget; (void)context; (void)time; (void)data;
+    set_drop_target(desperateOverview_ui_strip_cell_at(x, y, NULL, NULL));
+    return FALSE;
+}
+
+static void on_strip_drag_leave(GtkWidget *widget, GdkDragContext *context,
+                                guint time, gpointer data) {
+    (void)widget; (void)context; (void)time; (void)data;
+    set_drop_target(-1);
+}
+
+static void on_strip_destroy(GtkWidget *widget, gpointer data) {
+    (void)data;
+    if (g_cell_strip == widget)
+        g_cell_strip = NULL;
+    g_strip_drop_ws = -1;
+}
+
+GtkWidget *desperateOverview_ui_strip_new(void) {
+    GtkWidget *strip = gtk_drawing_area_new();
+    gtk_style_context_add_class(gtk_widget_get_style_context(strip), "desperateOverview-strip");
+    g_signal_connect(strip, "draw", G_CALLBACK(desperateOverview_ui_draw_strip), NULL);
+    g_signal_connect(strip, "destroy", G_CALLBACK(on_strip_destroy), NULL);
+    gtk_widget_add_events(strip,
+                          GDK_BUTTON_PRESS_MASK |
+                          GDK_BUTTON_RELEASE_MASK |
+                          GDK_POINTER_MOTION_MASK |
+                          GDK_BUTTON_MOTION_MASK |
+                          GDK_LEAVE_NOTIFY_MASK);
+    g_signal_connect(strip, "motion-notify-event",
+                     G_CALLBACK(desperateOverview_ui_on_cell_motion), NULL);
+    g_signal_connect(strip, "leave-notify-event",
+                     G_CALLBACK(desperateOverview_ui_on_cell_leave), NULL);
+    g_signal_connect(strip, "button-press-event",
+                     G_CALLBACK(desperateOverview_ui_on_cell_button_press), NULL);
+    g_signal_connect(strip, "button-release-event",
+                     G_CALLBACK(desperateOverview_ui_on_cell_button_release), NULL);
+    gtk_drag_source_set(strip,
+                        GDK_BUTTON1_MASK,
+                        g_drag_targets,
+                        g_drag_targets_count,
+                        GDK_ACTION_MOVE);
+    g_signal_connect(strip, "drag-begin",
+                     G_CALLBACK(desperateOverview_ui_on_cell_drag_begin), NULL);
+    g_signal_connect(strip, "drag-end",
+                     G_CALLBACK(desperateOverview_ui_on_cell_drag_end), NULL);
+    g_signal_connect(strip, "drag-data-get",
+                     G_CALLBACK(desperateOverview_ui_on_cell_drag_data_get), NULL);
+    /* No GTK_DEST_DEFAULT_HIGHLIGHT: it would frame the whole strip, the
+     * cell under the pointer is framed by the drag layer instead. */
+    gtk_drag_dest_set(strip,
+                      GTK_DEST_DEFAULT_MOTION |
+                      GTK_DEST_DEFAULT_DROP,
+                      g_drag_targets,
+                      g_drag_targets_count,
+                      GDK_ACTION_MOVE);
+    g_signal_connect(strip, "drag-motion", G_CALLBACK(on_strip_drag_motion), NULL);
+    g_signal_connect(strip, "drag-leave", G_CALLBACK(on_strip_drag_leave), NULL);
+    g_signal_connect(strip, "drag-drop",
+                     G_CALLBACK(desperateOverview_ui_on_cell_drag_drop), NULL);
+    g_signal_connect(strip, "drag-data-received",
+                     G_CALLBACK(desperateOverview_ui_on_cell_drag_data_received), NULL);
+    return strip;
+}
+
+void desperateOverview_ui_strip_set_layout(double cell_w, double cell_h, double gap, int columns) {
+    g_strip_cell_w = cell_w;
+    g_strip_cell_h = cell_h;
+    g_strip_gap = gap;
+    if (columns <= 0)
+        columns = MAX_WS;
+    for (int i = 0; i < MAX_WS; ++i) {
+        g_strip_cell_x[i] = (i % columns) * (cell_w + gap);
+        g_strip_cell_y[i] = (i / columns) * (cell_h + gap);
+    }
+    if (!g_cell_strip)
+        return;
+    int count = g_active_count > 0 ? g_active_count : 0;
+    int used_columns = count < columns ? count : columns;
+    int rows = count > 0 ? (count + columns - 1) / columns : 0;
+    double width = used_columns > 0 ? used_columns * cell_w + (used_columns - 1) * gap : 0.0;
+    double height = rows > 0 ? rows * cell_h + (rows - 1) * gap : 0.0;
+    gtk_widget_set_size_request(g_cell_strip, (int)ceil(width), (int)ceil(height));
+    gtk_widget_queue_draw(g_cell_strip);
+}
+
+void desperateOverview_ui_strip_get_cell_size(double *cell_w, double *cell_h) {
+    if (cell_w)
+        *cell_w = g_strip_cell_w;
+    if (cell_h)
+        *cell_h = g_strip_cell_h;
+}
+
+void desperateOverview_ui_strip_index_origin(int index, double *x, double *y) {
+    gboolean valid = index >= 0 && index < MAX_WS;
+    if (x)
+        *x = valid ? g_strip_cell_x[index] : 0.0;
+    if (y)
+        *y = valid ? g_strip_cell_y[index] : 0.0;
+}
+
+int desperateOverview_ui_strip_cell_at(double x, double y, double *cell_x, double *cell_y) {
+    for (int i = 0; i < g_active_count && i < MAX_WS; ++i) {
+        double local_x = x - g_strip_cell_x[i];
+        double local_y = y - g_strip_cell_y[i];
+        if (local_x < 0.0 || local_y < 0.0 ||
+            local_x > g_strip_cell_w || local_y > g_strip_cell_h)
+            continue;
+        if (cell_x)
+            *cell_x = local_x;
+        if (cell_y)
+            *cell_y = local_y;
+        return g_active_list[i];
+    }
+    return -1;
+}
+
+gboolean desperateOverview_ui_strip_cell_origin(int wsid, double *x, double *y) {
+    int index = desperateOverview_ui_find_active_index(wsid);
+    if (index < 0)
+        return FALSE;
+    desperateOverview_ui_strip_index_origin(index, x, y);
+    return TRUE;
+}
+
+void desperateOverview_ui_strip_queue_cell(int wsid) {
+    desperateOverview_ui_strip_queue_cell_area(wsid, 0, 0,
+                                               (int)ceil(g_strip_cell_w),
+                                               (int)ceil(g_strip_cell_h));
+}
+
+void desperateOverview_ui_strip_queue_cell_area(int wsid, int x, int y, int w, int h) {
+    double ox, oy;
+    if (!g_cell_strip || !desperateOverview_ui_strip_cell_origin(wsid, &ox, &oy))
+        return;
+    /* Clamp to the cell so damage never bleeds into a neighbour. */
+    int x0 = x > 0 ? x : 0;
+    int y0 = y > 0 ? y : 0;
+    int x1 = x + w < (int)ceil(g_strip_cell_w) ? x + w : (int)ceil(g_strip_cell_w);
+    int y1 = y + h < (int)ceil(g_strip_cell_h) ? y + h : (int)ceil(g_strip_cell_h);
+    if (x1 <= x0 || y1 <= y0)
+        return;
+    gtk_widget_queue_draw_area(g_cell_strip, (int)floor(ox) + x0, (int)floor(oy) + y0,
+                               x1 - x0, y1 - y0);
+}
+
+int desperateOverview_ui_strip_drop_target(void) {
+    return g_strip_drop_ws;
+}
+
+void desperateOverview_ui_strip_attach_scroller(GtkWidget *scroller) {
+    g_strip_scroller = scroller;
+    if (!scroller)
+        return;
+    g_signal_connect(scroller, "destroy", G_CALLBACK(on_scroller_destroy), NULL);
+    GtkAdjustment *adj = strip_hadjustment();
+    g_signal_connect(adj, "value-changed", G_CALLBACK(on_strip_scrolled), NULL);
+    g_signal_connect(adj, "changed", G_CALLBACK(on_strip_viewport_changed), NULL);
+}
+
+void desperateOverview_ui_strip_scroll_to(int wsid) {
+    ensure_cell_visible(wsid);
+}
+
+void desperateOverview_ui_strip_capture_range(int first, int last) {
+    uint64_t mask = 0;
+    if (first < 0)
+        first = 0;
+    for (int i = first; i <= last && i < g_active_count; ++i) {
+        int wsid = g_active_list[i];
+        if (wsid > 0 && wsid < MAX_WS)
+            mask |= UINT64_C(1) << wsid;
+    }
+    /* The current-workspace preview is always on screen. */
+    if (g_active_workspace > 0 && g_active_workspace < MAX_WS)
+        mask |= UINT64_C(1) << g_active_workspace;
+
+    uint64_t added = mask & ~g_strip_capture_mask;
+    if (mask == g_strip_capture_mask)
+        return;
+    g_strip_capture_mask = mask;
+    desperateOverview_core_set_capture_workspaces(mask);
+    if (added && g_overlay_visible)
+        desperateOverview_core_request_refresh_async();
+}
+
+void desperateOverview_ui_strip_capture_all(void) {
+    if (g_strip_capture_mask == CORE_CAPTURE_ALL_WORKSPACES)
+        return;
+    g_strip_capture_mask = CORE_CAPTURE_ALL_WORKSPACES;
+    desperateOverview_core_set_capture_workspaces(CORE_CAPTURE_ALL_WORKSPACES);
+}
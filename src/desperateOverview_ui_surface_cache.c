@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+
+#include "desperateOverview_ui_surface_cache.h"
+
+#include <gdk/gdk.h>
+
+#include "desperateOverview_geometry.h"
+#include "desperateOverview_metrics.h"
+#include "desperateOverview_ui_state.h"
+
+/* The slot keeps a reference on its source pixbuf, so a pointer match can
+ * never be a freed pixbuf whose address was reused by a new one. */
+typedef struct {
+    cairo_surface_t *surface;
+    GdkPixbuf *source;
+    guint32 content_crc;
+    int width;
+    int height;
+} SurfaceSlot;
+
+typedef struct {
+    SurfaceSlot slots[DESPERATEOVERVIEW_SURFACE_VIEW_COUNT];
+} SurfaceCacheEntry;
+
+static GHashTable *g_surface_cache = NULL;
+static cairo_surface_t *g_placeholder_icon = NULL;
+
+static void surface_slot_clear(SurfaceSlot *slot) {
+    if (slot->surface)
+        cairo_surface_destroy(slot->surface);
+    if (slot->source)
+        g_object_unref(slot->source);
+    *slot = (SurfaceSlot){ 0 };
+}
+
+static void surface_cache_entry_free(gpointer data) {
+    SurfaceCacheEntry *entry = data;
+    if (!entry)
+        return;
+    for (int v = 0; v < DESPERATEOVERVIEW_SURFACE_VIEW_COUNT; ++v)
+        surface_slot_clear(&entry->slots[v]);
+    g_free(entry);
+}
+
+void desperateOverview_surface_cache_init(void) {
+    if (g_surface_cache)
+        return;
+    g_surface_cache = g_hash_table_new_full(g_str_hash,
+                                            g_str_equal,
+                                            g_free,
+                                            surface_cache_entry_free);
+}
+
+void desperateOverview_surface_cache_shutdown(void) {
+    if (g_surface_cache) {
+        g_hash_table_destroy(g_surface_cache);
+        g_surface_cache = NULL;
+    }
+    if (g_placeholder_icon) {
+        cairo_surface_destroy(g_placeholder_icon);
+        g_placeholder_icon = NULL;
+    }
+}
+
+void desperateOverview_surface_cache_clear(void) {
+    if (g_surface_cache)
+        g_hash_table_remove_all(g_surface_cache);
+}
+
+static cairo_surface_t *build_surface(GdkPixbuf *source, int width, int height) {
+    uint64_t scale_start = desperateOverview_metrics_now_ns();
+    GdkPixbuf *scaled = gdk_pixbuf_scale_simple(source, width, height, GDK_INTERP_BILINEAR);
+    desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_PREVIEW_SCALE, scale_start);
+    if (!scaled)
+        return NULL;
+
+    cairo_surface_t *surface = gdk_cairo_surface_create_from_pixbuf(scaled, 1, NULL);
+    g_object_unref(scaled);
+    if (surface && cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return NULL;
+    }
+    return surface;
+}
+
+cairo_surface_t *desperateOverview_surface_cache_get(const char *addr,
+                                                     DesperateOverviewSurfaceView view,
+                                                     GdkPixbuf *source,
+                                                     guint32 content_crc,
+                                                     int width,
+                                                     int height) {
+    if (!source || width <= 0 || height <= 0 ||
+        view < 0 || view >= DESPERATEOVERVIEW_SURFACE_VIEW_COUNT)
+        return NULL;
+
+    /* Without the cache (or an address to key on) every call builds afresh. */
+    if (!g_surface_cache || !addr || !*addr)
+        return build_surface(source, width, height);
+
+    SurfaceCacheEntry *entry = g_hash_table_lookup(g_surface_cache, addr);
+    if (!entry) {
+        entry = g_new0(SurfaceCacheEntry, 1);
+        g_hash_table_insert(g_surface_cache, g_strdup(addr), entry);
+    }
+
+    SurfaceSlot *slot = &entry->slots[view];
+    if (slot->surface &&
+        slot->source == source &&
+        slot->content_crc == content_crc &&
+        slot->width == width &&
+        slot->height == height) {
+        desperateOverview_metrics_count(DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_HIT);
+        return cairo_surface_reference(slot->surface);
+    }
+
+    desperateOverview_metrics_count(DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_MISS);
+    surface_slot_clear(slot);
+    cairo_surface_t *surface = build_surface(source, width, height);
+    if (!surface)
+        return NULL;
+
+    slot->surface = surface;
+    slot->source = g_object_ref(source);
+    slot->content_crc = content_crc;
+    slot->width = width;
+    slot->height = height;
+    return cairo_surface_reference(surface);
+}
+
+/* The biggest view surface gives the sharpest icon for the same fixed cost. */
+static const SurfaceSlot *largest_view_slot(const SurfaceCacheEntry *entry) {
+    const SurfaceSlot *best = NULL;
+    for (int v = 0; v < DESPERATEOVERVIEW_SURFACE_VIEW_DRAG_ICON; ++v) {
+        const SurfaceSlot *slot = &entry->slots[v];
+        if (slot->surface && (!best || slot->width * slot->height > best->width * best->height))
+            best = slot;
+    }
+    return best;
+}
+
+static void center_hotspot(cairo_surface_t *surface, int width, int height) {
+    cairo_surface_set_device_offset(surface, -(double)width / 2.0, -(double)height / 2.0);
+}
+
+static cairo_surface_t *build_drag_icon(cairo_surface_t *view, int view_w, int view_h,
+                                        int width, int height) {
+    uint64_t scale_start = desperateOverview_metrics_now_ns();
+    cairo_surface_t *icon = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t *cr = cairo_create(icon);
+    cairo_scale(cr, (double)width / view_w, (double)height / view_h);
+    cairo_set_source_surface(cr, view, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    desperateOverview_metrics_record_since(DESPERATEOVERVIEW_METRIC_PREVIEW_SCALE, scale_start);
+    if (cairo_surface_status(icon) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(icon);
+        return NULL;
+    }
+    center_hotspot(icon, width, height);
+    return icon;
+}
+
+static cairo_surface_t *placeholder_icon(void) {
+    if (!g_placeholder_icon) {
+        const int w = 200;
+        const int h = 120;
+        g_placeholder_icon = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+        cairo_t *cr = cairo_create(g_placeholder_icon);
+        cairo_set_source_rgba(cr, 0x44 / 255.0, 0xaa / 255.0, 0xff / 255.0, 0x88 / 255.0);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+        center_hotspot(g_placeholder_icon, w, h);
+    }
+    return cairo_surface_reference(g_placeholder_icon);
+}
+
+cairo_surface_t *desperateOverview_surface_cache_get_drag_icon(const char *addr,
+                                                               int max_dim,
+                                                               int min_dim) {
+    SurfaceCacheEntry *entry = (g_surface_cache && addr && *addr)
+        ? g_hash_table_lookup(g_surface_cache, addr)
+        : NULL;
+    const SurfaceSlot *view = entry ? largest_view_slot(entry) : NULL;
+    if (!view || max_dim <= 0 || min_dim > max_dim)
+        return placeholder_icon();
+
+    int width = view->width;
+    int height = view->height;
+    if (width > max_dim || height > max_dim) {
+        double sx = (double)max_dim / (double)width;
+        double sy = (double)max_dim / (double)height;
+        double scale = (sx < sy) ? sx : sy;
+        width = (int)((double)width * scale + 0.5);
+        height = (int)((double)height * scale + 0.5);
+    }
+    width = desperateOverview_geometry_clamp_int(width, min_dim, max_dim);
+    height = desperateOverview_geometry_clamp_int(height, min_dim, max_dim);
+
+    /* Keyed on the view slot's source, so a new thumbnail or live frame
+     * painted in either view rebuilds the icon on the next drag. */
+    SurfaceSlot *slot = &entry->slots[DESPERATEOVERVIEW_SURFACE_VIEW_DRAG_ICON];
+    if (slot->surface &&
+        slot->source == view->source &&
+        slot->content_crc == view->content_crc &&
+        slot->width == width &&
+        slot->height == height) {
+        desperateOverview_metrics_count(DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_HIT);
+        return cairo_surface_reference(slot->surface);
+    }
+
+    desperateOverview_metrics_count(DESPERATEOVERVIEW_COUNTER_SURFACE_CACHE_MISS);
+    cairo_surface_t *icon = build_drag_icon(view->surface, view->width, view->height,
+                                            width, height);
+    if (!icon)
+        return placeholder_icon();
+
+    GdkPixbuf *source = g_object_ref(view->source);
+    guint32 content_crc = view->content_crc;
+    surface_slot_clear(slot);
+    slot->surface = icon;
+    slot->source = source;
+    slot->content_crc = content_crc;
+    slot->width = width;
+    slot->height = height;
+    return cairo_surface_reference(icon);
+}
+
+void desperateOverview_surface_cache_prune(void) {
+    if (!g_surface_cache || g_hash_table_size(g_surface_cache) == 0)
+        return;
+
+    GHashTable *present = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int wsid = 0; wsid < MAX_WS; ++wsid) {
+        WorkspaceWindows *W = &g_ws[wsid];
+        for (int i = 0; i < W->count; ++i) {
+            if (W->wins[i].addr[0])
+                g_hash_table_add(present, W->wins[i].addr);
+        }
+    }
+
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, g_surface_cache);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        if (!g_hash_table_contains(present, key))
+            g_hash_table_iter_remove(&iter);
+    }
+    g_hash_table_destroy(present);
+}
@@ -0,0 +1,467 @@
+#define _GNU_SOURCE
+
+/*
+ * Test-only Wayland server that advertises wl_shm and
+ * hyprland_toplevel_export_manager_v1 on a private socket and answers
+ * capture_toplevel with generated content. Point the overlay (or a bench)
+ * at it with WAYLAND_DISPLAY=<socket>.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <wayland-server.h>
+#include "hyprland-toplevel-export-v1-server-protocol.h"
+
+typedef enum {
+    DAMAGE_FULL,
+    DAMAGE_PARTIAL,
+    DAMAGE_NONE,
+} DamageMode;
+
+typedef struct {
+    const char *socket_name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t delay_ms;
+    uint32_t jitter_ms;
+    double   fail_rate;
+    DamageMode damage;
+    bool     verbose;
+} ServerOptions;
+
+typedef struct {
+    uint64_t frames_requested;
+    uint64_t frames_ready;
+    uint64_t frames_failed;
+    uint64_t bytes_copied;
+} ServerStats;
+
+typedef struct {
+    struct wl_resource *resource;
+    struct wl_resource *buffer;
+    struct wl_listener buffer_destroy;
+    struct wl_event_source *timer;
+    uint32_t handle;
+    int32_t ignore_damage;
+    bool copied;
+} ExportFrame;
+
+static ServerOptions g_opts = {
+    .socket_name = "desperateOverview-fake-0",
+    .width = 1280,
+    .height = 720,
+    .delay_ms = 0,
+    .jitter_ms = 0,
+    .fail_rate = 0.0,
+    .damage = DAMAGE_FULL,
+    .verbose = false,
+};
+static ServerStats g_stats;
+static struct wl_display *g_display = NULL;
+static uint64_t g_rng_state = 0x2545f4914f6cdd1dULL;
+static uint32_t g_frame_counter = 0;
+
+static uint64_t next_random(void) {
+    uint64_t x = g_rng_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    g_rng_state = x;
+    return x;
+}
+
+static double next_unit(void) {
+    return (double)(next_random() >> 11) / (double)(1ULL << 53);
+}
+
+static void frame_remove_timer(ExportFrame *frame) {
+    if (frame->timer) {
+        wl_event_source_remove(frame->timer);
+        frame->timer = NULL;
+    }
+}
+
+static void frame_detach_buffer(ExportFrame *frame) {
+    if (frame->buffer) {
+        wl_list_remove(&frame->buffer_destroy.link);
+        frame->buffer = NULL;
+    }
+}
+
+static void frame_handle_buffer_destroy(struct wl_listener *listener, void *data) {
+    (void)data;
+    ExportFrame *frame = wl_container_of(listener, frame, buffer_destroy);
+    wl_list_remove(&frame->buffer_destroy.link);
+    frame->buffer = NULL;
+}
+
+static void fill_pattern(uint8_t *pixels, int32_t stride, uint32_t w, uint32_t h,
+                         uint32_t handle, uint32_t frame_no) {
+    uint8_t base_r = (uint8_t)(handle * 37u);
+    uint8_t base_g = (uint8_t)(handle * 91u);
+    uint8_t base_b = (uint8_t)(handle * 173u);
+    uint32_t band = (frame_no * 8u) % (h > 0 ? h : 1);
+
+    for (uint32_t y = 0; y < h; ++y) {
+        uint32_t *row = (uint32_t *)(pixels + (size_t)y * (size_t)stride);
+        uint8_t gy = (uint8_t)((y * 255u) / (h > 1 ? h - 1 : 1));
+        bool in_band = y >= band && y < band + 8u;
+        for (uint32_t x = 0; x < w; ++x) {
+            uint8_t gx = (uint8_t)((x * 255u) / (w > 1 ? w - 1 : 1));
+            uint8_t r = (uint8_t)(base_r ^ gx);
+            uint8_t g = in_band ? 0xff : (uint8_t)(base_g + ((x >> 5) & 1u) * 40u);
+            uint8_t b = (uint8_t)(base_b ^ gy);
+            row[x] = 0xff000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+        }
+    }
+}
+
+static void send_damage(ExportFrame *frame, uint32_t frame_no) {
+    if (frame->ignore_damage)
+        return;
+    switch (g_opts.damage) {
+        case DAMAGE_FULL:
+            hyprland_toplevel_export_frame_v1_send_damage(frame->resource, 0, 0,
+                                                          g_opts.width, g_opts.height);
+            break;
+        case DAMAGE_PARTIAL: {
+            uint32_t band = (frame_no * 8u) % (g_opts.height > 0 ? g_opts.height : 1);
+            uint32_t band_h = band + 8u > g_opts.height ? g_opts.height - band : 8u;
+            hyprland_toplevel_export_frame_v1_send_damage(frame->resource, 0, band,
+                                                          g_opts.width, band_h);
+            break;
+        }
+        case DAMAGE_NONE:
+        default:
+            break;
+    }
+}
+
+static void frame_fail(ExportFrame *frame) {
+    g_stats.frames_failed++;
+    hyprland_toplevel_export_frame_v1_send_failed(frame->resource);
+}
+
+static int frame_complete(void *data) {
+    ExportFrame *frame = data;
+    frame_remove_timer(frame);
+
+    if (!frame->buffer) {
+        frame_fail(frame);
+        return 0;
+    }
+
+    if (g_opts.fail_rate > 0.0 && next_unit() < g_opts.fail_rate) {
+        frame_detach_buffer(frame);
+        frame_fail(frame);
+        return 0;
+    }
+
+    struct wl_shm_buffer *shm = wl_shm_buffer_get(frame->buffer);
+    if (!shm ||
+        (uint32_t)wl_shm_buffer_get_width(shm) != g_opts.width ||
+        (uint32_t)wl_shm_buffer_get_height(shm) != g_opts.height ||
+        wl_shm_buffer_get_stride(shm) < (int32_t)(g_opts.width * 4)) {
+        frame_detach_buffer(frame);
+        frame_fail(frame);
+        return 0;
+    }
+
+    uint32_t frame_no = g_frame_counter++;
+    int32_t stride = wl_shm_buffer_get_stride(shm);
+    wl_shm_buffer_begin_access(shm);
+    fill_pattern(wl_shm_buffer_get_data(shm), stride,
+                 g_opts.width, g_opts.height, frame->handle, frame_no);
+    wl_shm_buffer_end_access(shm);
+    frame_detach_buffer(frame);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t sec = (uint64_t)now.tv_sec;
+
+    send_damage(frame, frame_no);
+    hyprland_toplevel_export_frame_v1_send_flags(frame->resource, 0);
+    hyprland_toplevel_export_frame_v1_send_ready(frame->resource,
+                                                 (uint32_t)(sec >> 32),
+                                                 (uint32_t)(sec & 0xffffffffu),
+                                                 (uint32_t)now.tv_nsec);
+    g_stats.frames_ready++;
+    g_stats.bytes_copied += (uint64_t)stride * g_opts.height;
+    return 0;
+}
+
+static void frame_handle_copy(struct wl_client *client,
+                              struct wl_resource *resource,
+                              struct wl_resource *buffer,
+                              int32_t ignore_damage) {
+    (void)client;
+    ExportFrame *frame = wl_resource_get_user_data(resource);
+    if (frame->copied) {
+        wl_resource_post_error(resource,
+                               HYPRLAND_TOPLEVEL_EXPORT_FRAME_V1_ERROR_ALREADY_USED,
+                               "frame already used");
+        return;
+    }
+    frame->copied = true;
+    frame->ignore_damage = ignore_damage;
+
+    frame->buffer = buffer;
+    frame->buffer_destroy.notify = frame_handle_buffer_destroy;
+    wl_resource_add_destroy_listener(buffer, &frame->buffer_destroy);
+
+    uint32_t delay = g_opts.delay_ms;
+    if (g_opts.jitter_ms > 0)
+        delay += (uint32_t)(next_random() % (g_opts.jitter_ms + 1));
+
+    if (delay == 0) {
+        frame_complete(frame);
+        return;
+    }
+
+    struct wl_event_loop *loop = wl_display_get_event_loop(g_display);
+    frame->timer = wl_event_loop_add_timer(loop, frame_complete, frame);
+    if (!frame->timer) {
+        frame_complete(frame);
+        return;
+    }
+    wl_event_source_timer_update(frame->timer, (int)delay);
+}
+
+static void frame_handle_destroy(struct wl_client *client, struct wl_resource *resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static const struct hyprland_toplevel_export_frame_v1_interface frame_impl = {
+    .copy = frame_handle_copy,
+    .destroy = frame_handle_destroy,
+};
+
+static void frame_resource_destroy(struct wl_resource *resource) {
+    ExportFrame *frame = wl_resource_get_user_data(resource);
+    if (!frame)
+        return;
+    frame_remove_timer(frame);
+    frame_detach_buffer(frame);
+    free(frame);
+}
+
+static void create_frame(struct wl_client *client,
+                         struct wl_resource *manager,
+                         uint32_t id,
+                         uint32_t handle,
+                         bool supported) {
+    struct wl_resource *resource = wl_resource_create(client,
+                                                      &hyprland_toplevel_export_frame_v1_interface,
+                                                      wl_resource_get_version(manager),
+                                                      id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    ExportFrame *frame = calloc(1, sizeof(*frame));
+    if (!frame) {
+        wl_resource_destroy(resource);
+        wl_client_post_no_memory(client);
+        return;
+    }
+    frame->resource = resource;
+    frame->handle = handle;
+    wl_resource_set_implementation(resource, &frame_impl, frame, frame_resource_destroy);
+
+    g_stats.frames_requested++;
+    if (g_opts.verbose)
+        fprintf(stderr, "[fake-export] capture handle=0x%x\n", handle);
+
+    if (!supported) {
+        frame_fail(frame);
+        return;
+    }
+
+    hyprland_toplevel_export_frame_v1_send_buffer(resource,
+                                                  WL_SHM_FORMAT_XRGB8888,
+                                                  g_opts.width,
+                                                  g_opts.height,
+                                                  g_opts.width * 4);
+    hyprland_toplevel_export_frame_v1_send_buffer_done(resource);
+}
+
+static void manager_handle_capture_toplevel(struct wl_client *client,
+                                            struct wl_resource *resource,
+                                            uint32_t frame,
+                                            int32_t overlay_cursor,
+                                            uint32_t handle) {
+    (void)overlay_cursor;
+    create_frame(client, resource, frame, handle, true);
+}
+
+static void manager_handle_capture_toplevel_with_wlr_toplevel_handle(struct wl_client *client,
+                                                                     struct wl_resource *resource,
+                                                                     uint32_t frame,
+                                                                     int32_t overlay_cursor,
+                                                                     struct wl_resource *handle) {
+    (void)overlay_cursor;
+    (void)handle;
+    create_frame(client, resource, frame, 0, false);
+}
+
+static void manager_handle_destroy(struct wl_client *client, struct wl_resource *resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static const struct hyprland_toplevel_export_manager_v1_interface manager_impl = {
+    .capture_toplevel = manager_handle_capture_toplevel,
+    .destroy = manager_handle_destroy,
+    .capture_toplevel_with_wlr_toplevel_handle =
+        manager_handle_capture_toplevel_with_wlr_toplevel_handle,
+};
+
+static void manager_bind(struct wl_client *client, void *data, uint32_t version, uint32_t id) {
+    (void)data;
+    struct wl_resource *resource = wl_resource_create(client,
+                                                      &hyprland_toplevel_export_manager_v1_interface,
+                                                      (int)version,
+                                                      id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+    wl_resource_set_implementation(resource, &manager_impl, NULL, NULL);
+}
+
+static int handle_signal(int signal_number, void *data) {
+    (void)signal_number;
+    wl_display_terminate(data);
+    return 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --socket NAME       socket name under $XDG_RUNTIME_DIR (default %s)\n"
+            "  --size WxH          frame size in pixels (default %ux%u)\n"
+            "  --delay-ms N        delay between copy and ready (default 0)\n"
+            "  --jitter-ms N       extra random delay up to N ms\n"
+            "  --fail-rate F       fraction of copies answered with failed (0..1)\n"
+            "  --damage MODE       full, partial or none (default full)\n"
+            "  --seed N            seed for jitter and failures\n"
+            "  --verbose           log every capture request\n",
+            argv0, g_opts.socket_name, g_opts.width, g_opts.height);
+}
+
+static bool parse_options(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--verbose") == 0) {
+            g_opts.verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            exit(0);
+        }
+        if (!val) {
+            fprintf(stderr, "fake-export: %s requires a value\n", arg);
+            return false;
+        }
+        ++i;
+        if (strcmp(arg, "--socket") == 0) {
+            g_opts.socket_name = val;
+        } else if (strcmp(arg, "--size") == 0) {
+            unsigned w = 0, h = 0;
+            if (sscanf(val, "%ux%u", &w, &h) != 2 || w == 0 || h == 0) {
+                fprintf(stderr, "fake-export: invalid --size '%s'\n", val);
+                return false;
+            }
+            g_opts.width = w;
+            g_opts.height = h;
+        } else if (strcmp(arg, "--delay-ms") == 0) {
+            g_opts.delay_ms = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(arg, "--jitter-ms") == 0) {
+            g_opts.jitter_ms = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(arg, "--fail-rate") == 0) {
+            g_opts.fail_rate = strtod(val, NULL);
+        } else if (strcmp(arg, "--seed") == 0) {
+            g_rng_state = strtoull(val, NULL, 10) | 1ULL;
+        } else if (strcmp(arg, "--damage") == 0) {
+            if (strcmp(val, "full") == 0)
+                g_opts.damage = DAMAGE_FULL;
+            else if (strcmp(val, "partial") == 0)
+                g_opts.damage = DAMAGE_PARTIAL;
+            else if (strcmp(val, "none") == 0)
+                g_opts.damage = DAMAGE_NONE;
+            else {
+                fprintf(stderr, "fake-export: invalid --damage '%s'\n", val);
+                return false;
+            }
+        } else {
+            usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!parse_options(argc, argv))
+        return 1;
+
+    g_display = wl_display_create();
+    if (!g_display) {
+        fprintf(stderr, "fake-export: wl_display_create failed\n");
+        return 1;
+    }
+
+    if (wl_display_add_socket(g_display, g_opts.socket_name) != 0) {
+        fprintf(stderr, "fake-export: cannot create socket '%s': %s\n",
+                g_opts.socket_name, strerror(errno));
+        wl_display_destroy(g_display);
+        return 1;
+    }
+
+    if (wl_display_init_shm(g_display) != 0) {
+        fprintf(stderr, "fake-export: wl_display_init_shm failed\n");
+        wl_display_destroy(g_display);
+        return 1;
+    }
+
+    if (!wl_global_create(g_display, &hyprland_toplevel_export_manager_v1_interface,
+                          2, NULL, manager_bind)) {
+        fprintf(stderr, "fake-export: cannot create export manager global\n");
+        wl_display_destroy(g_display);
+        return 1;
+    }
+
+    struct wl_event_loop *loop = wl_display_get_event_loop(g_display);
+    struct wl_event_source *sigint = wl_event_loop_add_signal(loop, SIGINT, handle_signal, g_display);
+    struct wl_event_source *sigterm = wl_event_loop_add_signal(loop, SIGTERM, handle_signal, g_display);
+
+    fprintf(stderr, "fake-export: listening on WAYLAND_DISPLAY=%s (%ux%u, delay=%ums)\n",
+            g_opts.socket_name, g_opts.width, g_opts.height, g_opts.delay_ms);
+    wl_display_run(g_display);
+
+    if (sigint)
+        wl_event_source_remove(sigint);
+    if (sigterm)
+        wl_event_source_remove(sigterm);
+    wl_display_destroy_clients(g_display);
+    wl_display_destroy(g_display);
+
+    fprintf(stderr,
+            "fake-export: requested=%llu ready=%llu failed=%llu bytes=%llu\n",
+            (unsigned long long)g_stats.frames_requested,
+            (unsigned long long)g_stats.frames_ready,
+            (unsigned long long)g_stats.frames_failed,
+            (unsigned long long)g_stats.bytes_copied);
+    return 0;
+}
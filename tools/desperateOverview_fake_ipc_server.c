@@ -0,0 +1,854 @@
+#define _GNU_SOURCE
+
+/*
+ * Test-only stand-in for Hyprland's IPC sockets. It creates
+ * $XDG_RUNTIME_DIR/hypr/<signature>/.socket.sock and .socket2.sock, answers
+ * "j/<name>" queries from <fixtures>/<name>.json, acknowledges dispatches
+ * with "ok" and streams a scripted event file to every .socket2.sock
+ * listener at a fixed rate. Run the overlay or bench/ with the printed
+ * XDG_RUNTIME_DIR and HYPRLAND_INSTANCE_SIGNATURE.
+ *
+ * Queries are accepted on their own thread, so a client that refreshes
+ * synchronously per event keeps getting answers while the stream runs.
+ * Event listeners are non-blocking with a bounded per-listener queue; when
+ * a queue is full the stream either waits for it to drain (--backlog block,
+ * the default: nothing is lost and the rate falls to what the slowest
+ * listener consumes) or drops the event for that listener (--backlog drop,
+ * counted in fake/stats as events_dropped).
+ *
+ * Event script format: one "event>>data" line per event. Blank lines and
+ * lines starting with '#' are ignored; "@sleep <ms>" pauses the stream and
+ * "@state <n>" switches query replies to the fixtures in <fixtures>/state-<n>/
+ * (state-0 is active from the start; files missing from a state directory
+ * fall back to <fixtures>/).
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_FIXTURES      64
+#define MAX_STATES        256
+#define MAX_EVENT_CLIENTS 32
+#define REQUEST_MAX       8192
+#define EVENT_BACKLOG_MAX (256 * 1024)
+#define EVENT_LINE_MAX    1024    /* load_script() reads lines into char[1024] */
+
+typedef struct {
+    char name[64];
+    char *data;
+    size_t len;
+} Fixture;
+
+typedef struct {
+    Fixture items[MAX_FIXTURES];
+    int count;
+} FixtureSet;
+
+typedef enum {
+    SCRIPT_EVENT,
+    SCRIPT_SLEEP,
+    SCRIPT_STATE,
+} ScriptOp;
+
+typedef struct {
+    ScriptOp op;
+    uint32_t sleep_ms;
+    int state;
+    char *line;   /* "event>>data\n" */
+    size_t len;
+} ScriptEntry;
+
+typedef struct {
+    int fd;
+    char *queue;        /* bytes not yet accepted by the socket */
+    size_t queued;
+    size_t cap;
+} EventClient;
+
+typedef struct {
+    const char *runtime_dir;
+    const char *signature;
+    const char *fixtures_dir;
+    const char *events_path;
+    double rate;
+    bool loop;
+    bool wait_start;
+    int wait_clients;
+    uint32_t reply_delay_ms;
+    bool drop_on_backlog;
+    bool verbose;
+} Options;
+
+static Options g_opts = {
+    .runtime_dir = NULL,
+    .signature = "desperateOverview-fake",
+    .fixtures_dir = NULL,
+    .events_path = NULL,
+    .rate = 1000.0,
+    .loop = false,
+    .wait_start = false,
+    .wait_clients = 1,
+    .reply_delay_ms = 0,
+    .drop_on_backlog = false,
+    .verbose = false,
+};
+
+/* g_sets[0] is the fixtures dir itself, g_sets[n + 1] is state-<n>/. */
+static FixtureSet g_sets[MAX_STATES + 1];
+static int g_set_count = 0;
+static atomic_int g_current_state;
+
+static ScriptEntry *g_script = NULL;
+static size_t g_script_len = 0;
+
+/* Main thread only; request threads read g_listener_count. */
+static EventClient g_event_clients[MAX_EVENT_CLIENTS];
+static int g_event_client_count = 0;
+static atomic_int g_listener_count;
+
+static char g_sock_cmd[PATH_MAX];
+static char g_sock_evt[PATH_MAX];
+
+static volatile sig_atomic_t g_quit = 0;
+static atomic_bool g_start_requested;
+static atomic_bool g_script_done;
+static atomic_uint_fast64_t g_queries;
+static atomic_uint_fast64_t g_commands;
+static atomic_uint_fast64_t g_events_sent;
+static atomic_uint_fast64_t g_events_dropped;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ms(uint32_t ms) {
+    if (ms == 0)
+        return;
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000L,
+    };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR && !g_quit) {
+    }
+}
+
+static char *read_file(const char *path, size_t *out_len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return NULL;
+
+    size_t cap = 8192;
+    size_t len = 0;
+    char *buf = malloc(cap);
+    if (!buf) {
+        fclose(fp);
+        return NULL;
+    }
+
+    size_t n;
+    while ((n = fread(buf + len, 1, cap - len - 1, fp)) > 0) {
+        len += n;
+        if (cap - len - 1 == 0) {
+            cap *= 2;
+            char *tmp = realloc(buf, cap);
+            if (!tmp) {
+                free(buf);
+                fclose(fp);
+                return NULL;
+            }
+            buf = tmp;
+        }
+    }
+    buf[len] = 0;
+    fclose(fp);
+    if (out_len)
+        *out_len = len;
+    return buf;
+}
+
+static int load_fixture_set(const char *dir_path, FixtureSet *set) {
+    DIR *dir = opendir(dir_path);
+    if (!dir)
+        return -1;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char *dot = strrchr(ent->d_name, '.');
+        if (!dot || strcmp(dot, ".json") != 0)
+            continue;
+        if (set->count >= MAX_FIXTURES) {
+            fprintf(stderr, "fake-ipc: too many fixtures, ignoring %s\n", ent->d_name);
+            continue;
+        }
+
+        size_t name_len = (size_t)(dot - ent->d_name);
+        Fixture *fx = &set->items[set->count];
+        if (name_len == 0 || name_len >= sizeof(fx->name))
+            continue;
+
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir_path, ent->d_name);
+        fx->data = read_file(path, &fx->len);
+        if (!fx->data) {
+            fprintf(stderr, "fake-ipc: cannot read %s\n", path);
+            continue;
+        }
+        memcpy(fx->name, ent->d_name, name_len);
+        fx->name[name_len] = '\0';
+        set->count++;
+    }
+
+    closedir(dir);
+    return 0;
+}
+
+static int load_fixtures(const char *dir_path) {
+    if (load_fixture_set(dir_path, &g_sets[0]) < 0) {
+        fprintf(stderr, "fake-ipc: cannot open fixtures dir %s: %s\n",
+                dir_path, strerror(errno));
+        return -1;
+    }
+    g_set_count = 1;
+
+    for (int n = 0; n < MAX_STATES; ++n) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/state-%d", dir_path, n);
+        if (load_fixture_set(path, &g_sets[n + 1]) < 0)
+            break;
+        g_set_count = n + 2;
+    }
+    return 0;
+}
+
+static const Fixture *find_in_set(const FixtureSet *set, const char *name) {
+    for (int i = 0; i < set->count; ++i) {
+        if (strcmp(set->items[i].name, name) == 0)
+            return &set->items[i];
+    }
+    return NULL;
+}
+
+static const Fixture *find_fixture(const char *name) {
+    int state = atomic_load(&g_current_state);
+    if (state >= 0 && state + 1 < g_set_count) {
+        const Fixture *fx = find_in_set(&g_sets[state + 1], name);
+        if (fx)
+            return fx;
+    }
+    return find_in_set(&g_sets[0], name);
+}
+
+static int script_append(ScriptEntry entry) {
+    ScriptEntry *tmp = realloc(g_script, (g_script_len + 1) * sizeof(*g_script));
+    if (!tmp)
+        return -1;
+    g_script = tmp;
+    g_script[g_script_len++] = entry;
+    return 0;
+}
+
+static int load_script(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "fake-ipc: cannot open event script %s: %s\n",
+                path, strerror(errno));
+        return -1;
+    }
+
+    char line[1024];
+    unsigned lineno = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+        char *nl = strchr(line, '\n');
+        if (nl)
+            *nl = 0;
+        if (!line[0] || line[0] == '#')
+            continue;
+
+        if (line[0] == '@') {
+            unsigned ms = 0;
+            int state = 0;
+            if (sscanf(line, "@sleep %u", &ms) == 1) {
+                ScriptEntry e = { .op = SCRIPT_SLEEP, .sleep_ms = ms };
+                if (script_append(e) < 0)
+                    break;
+            } else if (sscanf(line, "@state %d", &state) == 1) {
+                ScriptEntry e = { .op = SCRIPT_STATE, .state = state };
+                if (script_append(e) < 0)
+                    break;
+            } else {
+                fprintf(stderr, "fake-ipc: %s:%u: unknown directive '%s'\n",
+                        path, lineno, line);
+            }
+            continue;
+        }
+
+        if (!strstr(line, ">>")) {
+            fprintf(stderr, "fake-ipc: %s:%u: missing '>>', skipping\n", path, lineno);
+            continue;
+        }
+
+        size_t len = strlen(line);
+        char *copy = malloc(len + 2);
+        if (!copy)
+            break;
+        memcpy(copy, line, len);
+        copy[len] = '\n';
+        copy[len + 1] = '\0';
+
+        ScriptEntry e = { .op = SCRIPT_EVENT, .line = copy, .len = len + 1 };
+        if (script_append(e) < 0) {
+            free(copy);
+            break;
+        }
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static void free_script(void) {
+    for (size_t i = 0; i < g_script_len; ++i)
+        free(g_script[i].line);
+    free(g_script);
+    g_script = NULL;
+    g_script_len = 0;
+}
+
+static int listen_unix_socket(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path) >= (int)sizeof(addr.sun_path)) {
+        close(fd);
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int mkdir_p(const char *path) {
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s", path);
+    for (char *p = tmp + 1; *p; ++p) {
+        if (*p != '/')
+            continue;
+        *p = '\0';
+        if (mkdir(tmp, 0700) < 0 && errno != EEXIST)
+            return -1;
+        *p = '/';
+    }
+    if (mkdir(tmp, 0700) < 0 && errno != EEXIST)
+        return -1;
+    return 0;
+}
+
+static void write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t w = send(fd, data, len, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += w;
+        len -= (size_t)w;
+    }
+}
+
+static void write_str(int fd, const char *s) {
+    write_all(fd, s, strlen(s));
+}
+
+static void reply_stats(int fd) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "queries %llu\ncommands %llu\nevents_sent %llu\nevents_dropped %llu\n"
+             "listeners %d\nscript_done %d\n",
+             (unsigned long long)atomic_load(&g_queries),
+             (unsigned long long)atomic_load(&g_commands),
+             (unsigned long long)atomic_load(&g_events_sent),
+             (unsigned long long)atomic_load(&g_events_dropped),
+             atomic_load(&g_listener_count),
+             atomic_load(&g_script_done) ? 1 : 0);
+    write_str(fd, buf);
+}
+
+/* Hyprland's request syntax: optional "[flags]/" prefix ('j' selects JSON),
+ * "[[BATCH]]cmd1;cmd2" for batches, and "fake/..." for our own controls. */
+static void handle_request(int fd, char *req) {
+    if (strncmp(req, "fake/", 5) == 0) {
+        const char *what = req + 5;
+        if (strcmp(what, "start") == 0) {
+            atomic_store(&g_start_requested, true);
+            write_str(fd, "ok");
+        } else if (strcmp(what, "stats") == 0) {
+            reply_stats(fd);
+        } else {
+            write_str(fd, "unknown request");
+        }
+        return;
+    }
+
+    if (strncmp(req, "[[BATCH]]", 9) == 0) {
+        atomic_fetch_add(&g_commands, 1);
+        const char *p = req + 9;
+        bool first = true;
+        while (*p) {
+            const char *semi = strchr(p, ';');
+            size_t len = semi ? (size_t)(semi - p) : strlen(p);
+            if (len > 0) {
+                if (!first)
+                    write_str(fd, "\n\n");
+                write_str(fd, "ok");
+                first = false;
+            }
+            if (!semi)
+                break;
+            p = semi + 1;
+        }
+        return;
+    }
+
+    const char *slash = strchr(req, '/');
+    const char *body = req;
+    bool json = false;
+    if (slash) {
+        for (const char *f = req; f < slash; ++f) {
+            if (*f == 'j')
+                json = true;
+        }
+        body = slash + 1;
+    }
+
+    if (strncmp(body, "dispatch", 8) == 0 || strncmp(body, "keyword", 7) == 0) {
+        atomic_fetch_add(&g_commands, 1);
+        write_str(fd, "ok");
+        return;
+    }
+
+    atomic_fetch_add(&g_queries, 1);
+    const Fixture *fx = find_fixture(body);
+    if (fx) {
+        write_all(fd, fx->data, fx->len);
+        return;
+    }
+    write_str(fd, json ? "{}" : "unknown request");
+}
+
+static void *request_thread(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    char req[REQUEST_MAX];
+    size_t len = 0;
+
+    /* Clients send the whole request in one write and then wait for the
+     * reply, so a single successful read is the complete request. */
+    for (;;) {
+        ssize_t n = read(fd, req + len, sizeof(req) - 1 - len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n > 0)
+            len += (size_t)n;
+        break;
+    }
+    req[len] = 0;
+
+    if (len > 0) {
+        if (g_opts.verbose)
+            fprintf(stderr, "fake-ipc: request '%s'\n", req);
+        sleep_ms(g_opts.reply_delay_ms);
+        handle_request(fd, req);
+    }
+    close(fd);
+    return NULL;
+}
+
+static void accept_request(int listen_fd) {
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_t tid;
+    if (pthread_create(&tid, &attr, request_thread, (void *)(intptr_t)fd) != 0)
+        close(fd);
+    pthread_attr_destroy(&attr);
+}
+
+/* Accepts .socket.sock connections until shutdown; each request is
+ * answered on its own thread. */
+static void *query_thread(void *arg) {
+    int listen_fd = (int)(intptr_t)arg;
+    while (!g_quit) {
+        struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+        int rc = poll(&pfd, 1, 100);
+        if (rc < 0 && errno != EINTR)
+            break;
+        if (rc > 0 && (pfd.revents & POLLIN))
+            accept_request(listen_fd);
+    }
+    return NULL;
+}
+
+static void accept_listener(int listen_fd) {
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0)
+        return;
+    if (g_event_client_count >= MAX_EVENT_CLIENTS) {
+        close(fd);
+        return;
+    }
+    g_event_clients[g_event_client_count++] = (EventClient){ .fd = fd };
+    atomic_store(&g_listener_count, g_event_client_count);
+    if (g_opts.verbose)
+        fprintf(stderr, "fake-ipc: event listener connected (%d)\n", g_event_client_count);
+}
+
+static void drop_listener(int index) {
+    EventClient *client = &g_event_clients[index];
+    close(client->fd);
+    free(client->queue);
+    g_event_clients[index] = g_event_clients[--g_event_client_count];
+    atomic_store(&g_listener_count, g_event_client_count);
+}
+
+/* Writes as much of the queue as the socket takes; false if the listener
+ * is gone. */
+static bool flush_listener(EventClient *client) {
+    size_t off = 0;
+    while (off < client->queued) {
+        ssize_t w = send(client->fd, client->queue + off, client->queued - off,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return false;
+        }
+        off += (size_t)w;
+    }
+    memmove(client->queue, client->queue + off, client->queued - off);
+    client->queued -= off;
+    return true;
+}
+
+static void flush_listeners(void) {
+    for (int i = 0; i < g_event_client_count;) {
+        if (g_event_clients[i].queued > 0 && !flush_listener(&g_event_clients[i])) {
+            drop_listener(i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+/* In block mode the stream holds back while any listener cannot take
+ * another event. */
+static bool listeners_backlogged(void) {
+    if (g_opts.drop_on_backlog)
+        return false;
+    for (int i = 0; i < g_event_client_count; ++i) {
+        if (g_event_clients[i].queued + EVENT_LINE_MAX > EVENT_BACKLOG_MAX)
+            return true;
+    }
+    return false;
+}
+
+static bool enqueue_event(EventClient *client, const char *line, size_t len) {
+    if (client->queued + len > EVENT_BACKLOG_MAX)
+        return false;
+    if (client->queued + len > client->cap) {
+        size_t cap = client->cap ? client->cap : 4096;
+        while (cap < client->queued + len)
+            cap *= 2;
+        char *tmp = realloc(client->queue, cap);
+        if (!tmp)
+            return false;
+        client->queue = tmp;
+        client->cap = cap;
+    }
+    memcpy(client->queue + client->queued, line, len);
+    client->queued += len;
+    return true;
+}
+
+static void broadcast(const char *line, size_t len) {
+    for (int i = 0; i < g_event_client_count;) {
+        EventClient *client = &g_event_clients[i];
+        if (!enqueue_event(client, line, len))
+            atomic_fetch_add(&g_events_dropped, 1);
+        if (!flush_listener(client)) {
+            drop_listener(i);
+            continue;
+        }
+        ++i;
+    }
+    atomic_fetch_add(&g_events_sent, 1);
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_quit = 1;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s --fixtures DIR [options]\n"
+            "  --runtime-dir DIR   base directory (default $XDG_RUNTIME_DIR)\n"
+            "  --signature SIG     HYPRLAND_INSTANCE_SIGNATURE to serve (default %s)\n"
+            "  --fixtures DIR      replies for j/<name> are read from DIR/<name>.json\n"
+            "  --events FILE       event script streamed to .socket2.sock listeners\n"
+            "  --rate N            events per second, 0 = unthrottled (default %.0f)\n"
+            "  --loop              restart the script when it ends\n"
+            "  --wait-clients N    start streaming once N listeners are connected (default %d)\n"
+            "  --wait-start        start streaming only after a 'fake/start' request\n"
+            "  --reply-delay-ms N  delay every query reply by N ms\n"
+            "  --backlog POLICY    full listener queue: 'block' the stream (default) or 'drop' events\n"
+            "  --verbose           log every request\n",
+            argv0, g_opts.signature, g_opts.rate, g_opts.wait_clients);
+}
+
+static int parse_args(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--verbose") == 0) {
+            g_opts.verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--loop") == 0) {
+            g_opts.loop = true;
+            continue;
+        }
+        if (strcmp(arg, "--wait-start") == 0) {
+            g_opts.wait_start = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            exit(0);
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return -1;
+        }
+        const char *val = argv[++i];
+        if (strcmp(arg, "--runtime-dir") == 0) {
+            g_opts.runtime_dir = val;
+        } else if (strcmp(arg, "--signature") == 0) {
+            g_opts.signature = val;
+        } else if (strcmp(arg, "--fixtures") == 0) {
+            g_opts.fixtures_dir = val;
+        } else if (strcmp(arg, "--events") == 0) {
+            g_opts.events_path = val;
+        } else if (strcmp(arg, "--rate") == 0) {
+            g_opts.rate = strtod(val, NULL);
+        } else if (strcmp(arg, "--wait-clients") == 0) {
+            g_opts.wait_clients = atoi(val);
+        } else if (strcmp(arg, "--reply-delay-ms") == 0) {
+            g_opts.reply_delay_ms = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(arg, "--backlog") == 0 &&
+                   (strcmp(val, "block") == 0 || strcmp(val, "drop") == 0)) {
+            g_opts.drop_on_backlog = strcmp(val, "drop") == 0;
+        } else {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (!g_opts.runtime_dir)
+        g_opts.runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (!g_opts.runtime_dir || !g_opts.fixtures_dir) {
+        usage(argv[0]);
+        return -1;
+    }
+    if (g_opts.rate < 0.0)
+        g_opts.rate = 0.0;
+    if (g_opts.wait_clients < 0)
+        g_opts.wait_clients = 0;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (parse_args(argc, argv) < 0)
+        return 2;
+
+    if (load_fixtures(g_opts.fixtures_dir) < 0)
+        return 1;
+    if (g_opts.events_path && load_script(g_opts.events_path) < 0)
+        return 1;
+
+    char dir[PATH_MAX - 32];
+    snprintf(dir, sizeof(dir), "%s/hypr/%s", g_opts.runtime_dir, g_opts.signature);
+    if (mkdir_p(dir) < 0) {
+        fprintf(stderr, "fake-ipc: cannot create %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+    snprintf(g_sock_cmd, sizeof(g_sock_cmd), "%s/.socket.sock", dir);
+    snprintf(g_sock_evt, sizeof(g_sock_evt), "%s/.socket2.sock", dir);
+
+    int cmd_fd = listen_unix_socket(g_sock_cmd);
+    int evt_fd = listen_unix_socket(g_sock_evt);
+    if (cmd_fd < 0 || evt_fd < 0) {
+        fprintf(stderr, "fake-ipc: cannot listen in %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    /* Signals go to the main thread, whose poll() they interrupt. */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    pthread_t query_tid;
+    int query_rc = pthread_create(&query_tid, NULL, query_thread, (void *)(intptr_t)cmd_fd);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (query_rc != 0) {
+        fprintf(stderr, "fake-ipc: cannot start the query thread\n");
+        return 1;
+    }
+
+    printf("export XDG_RUNTIME_DIR=%s\n", g_opts.runtime_dir);
+    printf("export HYPRLAND_INSTANCE_SIGNATURE=%s\n", g_opts.signature);
+    fflush(stdout);
+    fprintf(stderr, "fake-ipc: %d fixtures, %d states, %zu script entries\n",
+            g_sets[0].count, g_set_count - 1, g_script_len);
+
+    const uint64_t interval_ns = g_opts.rate > 0.0 ? (uint64_t)(1e9 / g_opts.rate) : 0;
+    uint64_t next_ns = 0;
+    uint64_t stream_start_ns = 0;
+    size_t cursor = 0;
+    bool streaming = false;
+
+    while (!g_quit) {
+        if (!streaming && g_script_len > 0 && !atomic_load(&g_script_done)) {
+            bool ready = g_opts.wait_start
+                ? atomic_load(&g_start_requested)
+                : g_event_client_count >= g_opts.wait_clients;
+            if (ready) {
+                streaming = true;
+                stream_start_ns = now_ns();
+                next_ns = stream_start_ns;
+            }
+        }
+
+        bool backlogged = streaming && listeners_backlogged();
+        int timeout_ms = -1;
+        if (streaming && !backlogged) {
+            uint64_t now = now_ns();
+            timeout_ms = next_ns > now ? (int)((next_ns - now + 999999) / 1000000) : 0;
+        } else if (g_opts.wait_start && g_script_len > 0) {
+            timeout_ms = 10;
+        }
+
+        struct pollfd pfds[1 + MAX_EVENT_CLIENTS];
+        pfds[0] = (struct pollfd){ .fd = evt_fd, .events = POLLIN };
+        int nfds = 1;
+        for (int i = 0; i < g_event_client_count; ++i) {
+            if (g_event_clients[i].queued > 0)
+                pfds[nfds++] = (struct pollfd){ .fd = g_event_clients[i].fd, .events = POLLOUT };
+        }
+        int rc = poll(pfds, (nfds_t)nfds, timeout_ms);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (pfds[0].revents & POLLIN)
+            accept_listener(evt_fd);
+        if (nfds > 1)
+            flush_listeners();
+        if (streaming && listeners_backlogged()) {
+            /* Deadlines slip with the listener instead of bursting later. */
+            next_ns = now_ns();
+            continue;
+        }
+
+        /* Emit entries whose deadline has passed; with --rate 0 the script
+         * goes out back to back in bursts so new connections still get
+         * accepted. */
+        int burst = 0;
+        while (streaming && !g_quit && burst++ < 256 && now_ns() >= next_ns &&
+               !listeners_backlogged()) {
+            const ScriptEntry *e = &g_script[cursor];
+            if (e->op == SCRIPT_SLEEP) {
+                next_ns = now_ns() + (uint64_t)e->sleep_ms * 1000000ull;
+            } else if (e->op == SCRIPT_STATE) {
+                atomic_store(&g_current_state, e->state);
+            } else {
+                broadcast(e->line, e->len);
+                next_ns += interval_ns;
+            }
+
+            if (++cursor >= g_script_len) {
+                cursor = 0;
+                if (!g_opts.loop) {
+                    streaming = false;
+                    atomic_store(&g_script_done, true);
+                    double secs = (double)(now_ns() - stream_start_ns) / 1e9;
+                    fprintf(stderr, "fake-ipc: script finished, %llu events in %.3f s\n",
+                            (unsigned long long)atomic_load(&g_events_sent), secs);
+                }
+            }
+            if (interval_ns > 0)
+                break;
+        }
+    }
+
+    g_quit = 1;
+    pthread_join(query_tid, NULL);
+
+    fprintf(stderr, "fake-ipc: queries=%llu commands=%llu events=%llu dropped=%llu\n",
+            (unsigned long long)atomic_load(&g_queries),
+            (unsigned long long)atomic_load(&g_commands),
+            (unsigned long long)atomic_load(&g_events_sent),
+            (unsigned long long)atomic_load(&g_events_dropped));
+
+    while (g_event_client_count > 0)
+        drop_listener(0);
+    close(cmd_fd);
+    close(evt_fd);
+    unlink(g_sock_cmd);
+    unlink(g_sock_evt);
+    for (int n = 0; n < g_set_count; ++n) {
+        for (int i = 0; i < g_sets[n].count; ++i)
+            free(g_sets[n].items[i].data);
+    }
+    free_script();
+    return 0;
+}
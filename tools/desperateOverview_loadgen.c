@@ -0,0 +1,440 @@
+#define _GNU_SOURCE
+
+/*
+ * Synthetic load generator for the fake IPC server. It simulates a session
+ * with many windows spread over many workspaces and monitors, applies a
+ * random stream of open/close/move operations to it and writes
+ *
+ *   <out>/{monitors,workspaces,activeworkspace,clients}.json  initial state
+ *   <out>/state-<n>/...json                                   snapshots
+ *   <out>/events.txt                                          event storm
+ *
+ * events.txt switches snapshots with "@state <n>" so the replies the core
+ * fetches keep up with the churn the events announce. Storm the IPC bench
+ * with it:
+ *
+ *   tools/desperateOverview-loadgen --out /tmp/storm
+ *   tools/desperateOverview-fake-ipc-server --runtime-dir /tmp/fake \
+ *       --fixtures /tmp/storm --events /tmp/storm/events.txt --rate 5000 --wait-start &
+ *   XDG_RUNTIME_DIR=/tmp/fake HYPRLAND_INSTANCE_SIGNATURE=desperateOverview-fake \
+ *       bench/desperateOverview_bench_ipc --iterations 50 --events 30000
+ *
+ * The bench stops when the script ends; with the default options that is
+ * about 26000 events, or 5.3 s at 5000 events per second.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MAX_MONITORS 16
+#define MAX_WORKSPACES 256
+
+typedef struct {
+    uint64_t addr;
+    int workspace;
+    int x, y, w, h;
+    bool floating;
+    int cls;
+    unsigned focus_id;
+} SimWindow;
+
+typedef struct {
+    const char *out_dir;
+    int windows;
+    int workspaces;
+    int monitors;
+    int states;
+    long events;
+    int weight_open;
+    int weight_close;
+    int weight_move;
+    int noise_pct;
+    uint64_t seed;
+} GenOptions;
+
+static const char *kClasses[] = {
+    "foot", "firefox", "code", "kitty", "thunar", "mpv", "discord", "obsidian",
+};
+#define CLASS_COUNT ((int)(sizeof(kClasses) / sizeof(kClasses[0])))
+
+static SimWindow *g_wins = NULL;
+static int g_win_count = 0;
+static int g_win_cap = 0;
+static uint64_t g_next_addr = 0x55aa00001000ull;
+static unsigned g_focus_counter = 0;
+static int g_active_ws = 1;
+static uint64_t g_rng;
+
+static uint64_t rng_next(void) {
+    /* xorshift64* */
+    g_rng ^= g_rng >> 12;
+    g_rng ^= g_rng << 25;
+    g_rng ^= g_rng >> 27;
+    return g_rng * 0x2545f4914f6cdd1dull;
+}
+
+static int rng_range(int n) {
+    return n > 0 ? (int)(rng_next() % (uint64_t)n) : 0;
+}
+
+static int monitor_of(int ws, const GenOptions *opts) {
+    return (ws - 1) % opts->monitors;
+}
+
+static int monitor_width(int mon) {
+    return (mon % 2) ? 2560 : 1920;
+}
+
+static int monitor_height(int mon) {
+    return (mon % 2) ? 1440 : 1080;
+}
+
+static int monitor_x(int mon) {
+    int x = 0;
+    for (int i = 0; i < mon; ++i)
+        x += monitor_width(i);
+    return x;
+}
+
+static void place_window(SimWindow *win, const GenOptions *opts) {
+    int mon = monitor_of(win->workspace, opts);
+    int mw = monitor_width(mon);
+    int mh = monitor_height(mon);
+    win->floating = rng_range(10) == 0;
+    if (win->floating) {
+        win->w = mw / 3 + rng_range(mw / 3);
+        win->h = mh / 3 + rng_range(mh / 3);
+        win->x = monitor_x(mon) + rng_range(mw - win->w);
+        win->y = rng_range(mh - win->h);
+    } else {
+        int cols = 1 + rng_range(3);
+        int rows = 1 + rng_range(2);
+        int col = rng_range(cols);
+        int row = rng_range(rows);
+        win->w = mw / cols - 20;
+        win->h = (mh - 40) / rows - 20;
+        win->x = monitor_x(mon) + col * (mw / cols) + 10;
+        win->y = 40 + row * ((mh - 40) / rows) + 10;
+    }
+}
+
+static SimWindow *add_window(int ws, const GenOptions *opts) {
+    if (g_win_count == g_win_cap) {
+        int cap = g_win_cap ? g_win_cap * 2 : 256;
+        SimWindow *tmp = realloc(g_wins, (size_t)cap * sizeof(*tmp));
+        if (!tmp)
+            return NULL;
+        g_wins = tmp;
+        g_win_cap = cap;
+    }
+    SimWindow *win = &g_wins[g_win_count++];
+    memset(win, 0, sizeof(*win));
+    win->addr = g_next_addr;
+    g_next_addr += 0x10 + (uint64_t)rng_range(0x100) * 0x10;
+    win->workspace = ws;
+    win->cls = rng_range(CLASS_COUNT);
+    win->focus_id = g_focus_counter++;
+    place_window(win, opts);
+    return win;
+}
+
+static int cmp_focus_desc(const void *a, const void *b) {
+    unsigned fa = g_wins[*(const int *)a].focus_id;
+    unsigned fb = g_wins[*(const int *)b].focus_id;
+    return (fa < fb) - (fa > fb);
+}
+
+/* Hyprland's focusHistoryID is a dense 0..n-1 ranking, 0 being the most
+ * recently focused window. focus_id only grows and closes leave holes in
+ * it, so the ranking is rebuilt for every snapshot. */
+static unsigned *focus_ranks(void) {
+    unsigned *ranks = calloc((size_t)(g_win_count ? g_win_count : 1), sizeof(*ranks));
+    int *order = malloc((size_t)(g_win_count ? g_win_count : 1) * sizeof(*order));
+    if (!ranks || !order) {
+        free(ranks);
+        free(order);
+        return NULL;
+    }
+    for (int i = 0; i < g_win_count; ++i)
+        order[i] = i;
+    qsort(order, (size_t)g_win_count, sizeof(*order), cmp_focus_desc);
+    for (int pos = 0; pos < g_win_count; ++pos)
+        ranks[order[pos]] = (unsigned)pos;
+    free(order);
+    return ranks;
+}
+
+static FILE *open_out(const char *dir, const char *name) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        fprintf(stderr, "loadgen: cannot write %s: %s\n", path, strerror(errno));
+    return fp;
+}
+
+static int write_snapshot(const char *dir, const GenOptions *opts) {
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        fprintf(stderr, "loadgen: cannot create %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+
+    int counts[MAX_WORKSPACES + 1] = {0};
+    for (int i = 0; i < g_win_count; ++i)
+        counts[g_wins[i].workspace]++;
+
+    FILE *fp = open_out(dir, "monitors.json");
+    if (!fp)
+        return -1;
+    fprintf(fp, "[\n");
+    int active_mon = monitor_of(g_active_ws, opts);
+    for (int m = 0; m < opts->monitors; ++m) {
+        int ws = m == active_mon ? g_active_ws : m + 1;
+        fprintf(fp,
+                "  {\"id\": %d, \"name\": \"FAKE-%d\", \"width\": %d, \"height\": %d, "
+                "\"x\": %d, \"y\": 0, \"transform\": 0, \"focused\": %s, "
+                "\"activeWorkspace\": {\"id\": %d, \"name\": \"%d\"}}%s\n",
+                m, m + 1, monitor_width(m), monitor_height(m), monitor_x(m),
+                m == active_mon ? "true" : "false", ws, ws,
+                m + 1 < opts->monitors ? "," : "");
+    }
+    fprintf(fp, "]\n");
+    fclose(fp);
+
+    fp = open_out(dir, "activeworkspace.json");
+    if (!fp)
+        return -1;
+    fprintf(fp, "{\"id\": %d, \"name\": \"%d\", \"monitor\": \"FAKE-%d\", "
+                "\"monitorID\": %d, \"windows\": %d}\n",
+            g_active_ws, g_active_ws, active_mon + 1, active_mon, counts[g_active_ws]);
+    fclose(fp);
+
+    fp = open_out(dir, "workspaces.json");
+    if (!fp)
+        return -1;
+    fprintf(fp, "[\n");
+    bool first = true;
+    for (int ws = 1; ws <= opts->workspaces; ++ws) {
+        if (counts[ws] == 0 && ws != g_active_ws)
+            continue;
+        int mon = monitor_of(ws, opts);
+        fprintf(fp, "%s  {\"id\": %d, \"name\": \"%d\", \"monitor\": \"FAKE-%d\", "
+                    "\"monitorID\": %d, \"windows\": %d}",
+                first ? "" : ",\n", ws, ws, mon + 1, mon, counts[ws]);
+        first = false;
+    }
+    fprintf(fp, "\n]\n");
+    fclose(fp);
+
+    unsigned *ranks = focus_ranks();
+    if (!ranks)
+        return -1;
+    fp = open_out(dir, "clients.json");
+    if (!fp) {
+        free(ranks);
+        return -1;
+    }
+    fprintf(fp, "[\n");
+    for (int i = 0; i < g_win_count; ++i) {
+        const SimWindow *w = &g_wins[i];
+        const char *cls = kClasses[w->cls];
+        fprintf(fp,
+                "  {\"address\": \"0x%llx\", \"mapped\": true, \"hidden\": false, "
+                "\"at\": [%d, %d], \"size\": [%d, %d], "
+                "\"workspace\": {\"id\": %d, \"name\": \"%d\"}, \"floating\": %s, "
+                "\"monitor\": %d, \"class\": \"%s\", \"title\": \"%s %llx\", "
+                "\"initialClass\": \"%s\", \"initialTitle\": \"%s\", "
+                "\"pid\": %d, \"focusHistoryID\": %u}%s\n",
+                (unsigned long long)w->addr, w->x, w->y, w->w, w->h,
+                w->workspace, w->workspace, w->floating ? "true" : "false",
+                monitor_of(w->workspace, opts), cls, cls, (unsigned long long)w->addr,
+                cls, cls, 1000 + i, ranks[i],
+                i + 1 < g_win_count ? "," : "");
+    }
+    fprintf(fp, "]\n");
+    fclose(fp);
+    free(ranks);
+    return 0;
+}
+
+static void emit_noise(FILE *ev) {
+    if (g_win_count == 0)
+        return;
+    const SimWindow *w = &g_wins[rng_range(g_win_count)];
+    if (rng_range(2)) {
+        fprintf(ev, "activewindowv2>>%llx\n", (unsigned long long)w->addr);
+    } else {
+        fprintf(ev, "windowtitlev2>>%llx,%s %u\n",
+                (unsigned long long)w->addr, kClasses[w->cls], (unsigned)rng_range(1000));
+    }
+}
+
+static void emit_op(FILE *ev, const GenOptions *opts) {
+    int total = opts->weight_open + opts->weight_close + opts->weight_move;
+    int roll = rng_range(total);
+
+    if (roll < opts->weight_open || g_win_count == 0) {
+        int ws = 1 + rng_range(opts->workspaces);
+        SimWindow *w = add_window(ws, opts);
+        if (!w)
+            return;
+        fprintf(ev, "openwindow>>%llx,%d,%s,%s\n",
+                (unsigned long long)w->addr, ws, kClasses[w->cls], kClasses[w->cls]);
+        return;
+    }
+
+    int idx = rng_range(g_win_count);
+    if (roll < opts->weight_open + opts->weight_close) {
+        fprintf(ev, "closewindow>>%llx\n", (unsigned long long)g_wins[idx].addr);
+        g_wins[idx] = g_wins[--g_win_count];
+        return;
+    }
+
+    SimWindow *w = &g_wins[idx];
+    int ws = 1 + rng_range(opts->workspaces);
+    w->workspace = ws;
+    w->focus_id = g_focus_counter++;
+    place_window(w, opts);
+    fprintf(ev, "movewindowv2>>%llx,%d,%d\n", (unsigned long long)w->addr, ws, ws);
+    if (rng_range(8) == 0) {
+        g_active_ws = ws;
+        fprintf(ev, "workspacev2>>%d,%d\n", ws, ws);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s --out DIR [options]\n"
+            "  --windows N      initial window count (default 400)\n"
+            "  --workspaces N   workspaces to spread windows over (default 24)\n"
+            "  --monitors N     monitors (default 2, max %d)\n"
+            "  --events N       structural events in the storm (default 20000)\n"
+            "  --states N       snapshots the storm is split into (default 16)\n"
+            "  --mix O:C:M      open/close/move weights (default 40:40:20)\n"
+            "  --noise PCT      extra focus/title events per 100 structural ones (default 30)\n"
+            "  --seed N         RNG seed (default 1)\n",
+            argv0, MAX_MONITORS);
+}
+
+int main(int argc, char **argv) {
+    GenOptions opts = {
+        .out_dir = NULL,
+        .windows = 400,
+        .workspaces = 24,
+        .monitors = 2,
+        .states = 16,
+        .events = 20000,
+        .weight_open = 40,
+        .weight_close = 40,
+        .weight_move = 20,
+        .noise_pct = 30,
+        .seed = 1,
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *val = argv[++i];
+        if (strcmp(argv[i - 1], "--out") == 0) {
+            opts.out_dir = val;
+        } else if (strcmp(argv[i - 1], "--windows") == 0) {
+            opts.windows = atoi(val);
+        } else if (strcmp(argv[i - 1], "--workspaces") == 0) {
+            opts.workspaces = atoi(val);
+        } else if (strcmp(argv[i - 1], "--monitors") == 0) {
+            opts.monitors = atoi(val);
+        } else if (strcmp(argv[i - 1], "--events") == 0) {
+            opts.events = atol(val);
+        } else if (strcmp(argv[i - 1], "--states") == 0) {
+            opts.states = atoi(val);
+        } else if (strcmp(argv[i - 1], "--mix") == 0) {
+            if (sscanf(val, "%d:%d:%d", &opts.weight_open, &opts.weight_close,
+                       &opts.weight_move) != 3) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(argv[i - 1], "--noise") == 0) {
+            opts.noise_pct = atoi(val);
+        } else if (strcmp(argv[i - 1], "--seed") == 0) {
+            opts.seed = strtoull(val, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!opts.out_dir) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (opts.workspaces < 1 || opts.workspaces > MAX_WORKSPACES)
+        opts.workspaces = opts.workspaces < 1 ? 1 : MAX_WORKSPACES;
+    if (opts.monitors < 1 || opts.monitors > MAX_MONITORS)
+        opts.monitors = opts.monitors < 1 ? 1 : MAX_MONITORS;
+    if (opts.states < 1)
+        opts.states = 1;
+    if (opts.states > 256)
+        opts.states = 256;
+    if (opts.weight_open + opts.weight_close + opts.weight_move <= 0)
+        opts.weight_open = 1;
+    if (opts.events < 0)
+        opts.events = 0;
+    g_rng = opts.seed ? opts.seed * 0x9e3779b97f4a7c15ull : 0x9e3779b97f4a7c15ull;
+
+    if (mkdir(opts.out_dir, 0755) < 0 && errno != EEXIST) {
+        fprintf(stderr, "loadgen: cannot create %s: %s\n", opts.out_dir, strerror(errno));
+        return 1;
+    }
+
+    for (int i = 0; i < opts.windows; ++i)
+        add_window(1 + rng_range(opts.workspaces), &opts);
+
+    if (write_snapshot(opts.out_dir, &opts) < 0)
+        return 1;
+
+    FILE *ev = open_out(opts.out_dir, "events.txt");
+    if (!ev)
+        return 1;
+    fprintf(ev, "# generated by desperateOverview_loadgen: %d windows, %d workspaces, "
+                "%d monitors, seed %llu\n",
+            opts.windows, opts.workspaces, opts.monitors, (unsigned long long)opts.seed);
+
+    /* The storm is split into segments; state-<n> is the model after
+     * segment n and "@state n" precedes it, so refreshes during a segment
+     * see where it ends up rather than the exact intermediate state. */
+    long per_state = (opts.events + opts.states - 1) / opts.states;
+    long emitted = 0;
+    for (int state = 0; state < opts.states; ++state) {
+        fprintf(ev, "@state %d\n", state);
+        for (long i = 0; i < per_state && emitted < opts.events; ++i, ++emitted) {
+            emit_op(ev, &opts);
+            if (rng_range(100) < opts.noise_pct)
+                emit_noise(ev);
+        }
+
+        char dir[PATH_MAX];
+        snprintf(dir, sizeof(dir), "%s/state-%d", opts.out_dir, state);
+        if (write_snapshot(dir, &opts) < 0) {
+            fclose(ev);
+            return 1;
+        }
+    }
+    fclose(ev);
+
+    fprintf(stderr, "loadgen: %ld events, %d states, %d windows at the end, written to %s\n",
+            emitted, opts.states, g_win_count, opts.out_dir);
+    free(g_wins);
+    return 0;
+}